@@ -0,0 +1,129 @@
+#include "char_set.h"
+
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CHAR_SET_X86
+#include <immintrin.h>
+#endif
+
+using namespace std::literals;
+
+namespace {
+
+    // Vectorized part of the search: the offset of the first match or of the tail shorter than a block
+    using BlockSearch = size_t (*)(const char* data, size_t size, const char* chars, size_t count);
+
+    size_t SearchNoBlocks(const char*, size_t, const char*, size_t) {
+        return 0;
+    }
+
+#ifdef CHAR_SET_X86
+    __attribute__((target("sse2")))
+    size_t SearchSse2(const char* data, size_t size, const char* chars, size_t count) {
+        constexpr size_t BLOCK_SIZE = 16;
+
+        __m128i patterns[CharSet::MAX_SIZE];
+        for (size_t idx = 0; idx < count; ++idx) {
+            patterns[idx] = _mm_set1_epi8(chars[idx]);
+        }
+
+        size_t offset = 0;
+        for (; offset + BLOCK_SIZE <= size; offset += BLOCK_SIZE) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+
+            __m128i matches = _mm_setzero_si128();
+            for (size_t idx = 0; idx < count; ++idx) {
+                matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, patterns[idx]));
+            }
+
+            if (const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(matches)); mask != 0) {
+                return offset + static_cast<size_t>(__builtin_ctz(mask));
+            }
+        }
+
+        return offset;
+    }
+
+    __attribute__((target("avx2")))
+    size_t SearchAvx2(const char* data, size_t size, const char* chars, size_t count) {
+        constexpr size_t BLOCK_SIZE = 32;
+
+        __m256i patterns[CharSet::MAX_SIZE];
+        for (size_t idx = 0; idx < count; ++idx) {
+            patterns[idx] = _mm256_set1_epi8(chars[idx]);
+        }
+
+        size_t offset = 0;
+        for (; offset + BLOCK_SIZE <= size; offset += BLOCK_SIZE) {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+
+            __m256i matches = _mm256_setzero_si256();
+            for (size_t idx = 0; idx < count; ++idx) {
+                matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, patterns[idx]));
+            }
+
+            if (const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(matches)); mask != 0) {
+                return offset + static_cast<size_t>(__builtin_ctz(mask));
+            }
+        }
+
+        // the tail may still fill a 16 bytes block
+        return offset + SearchSse2(data + offset, size - offset, chars, count);
+    }
+#endif
+
+    BlockSearch SelectBlockSearch() {
+#ifdef CHAR_SET_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2")) {
+            return SearchAvx2;
+        }
+
+        if (__builtin_cpu_supports("sse2")) {
+            return SearchSse2;
+        }
+#endif
+        return SearchNoBlocks;
+    }
+
+    // short texts are not worth the setup of the vectors
+    constexpr size_t MIN_BLOCK_SEARCH_SIZE = 16;
+
+} // namespace
+
+CharSet::CharSet(std::string_view chars) {
+    if (chars.size() > MAX_SIZE) {
+        throw std::invalid_argument("Too many chars for a set: "s + std::string(chars));
+    }
+
+    for (const char c : chars) {
+        if (!Contains(c)) {
+            chars_[size_++] = c;
+            table_[static_cast<unsigned char>(c)] = true;
+        }
+    }
+}
+
+size_t CharSet::FindIn(std::string_view text, size_t pos) const {
+    static const BlockSearch block_search = SelectBlockSearch();
+
+    if (pos >= text.size()) {
+        return text.size();
+    }
+
+    if (text.size() - pos >= MIN_BLOCK_SEARCH_SIZE) {
+        pos += block_search(text.data() + pos, text.size() - pos, chars_.data(), size_);
+    }
+
+    while (pos < text.size() && !Contains(text[pos])) {
+        ++pos;
+    }
+
+    return pos;
+}
+
+bool CharSet::Contains(char c) const {
+    return table_[static_cast<unsigned char>(c)];
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+// Small set of chars searched in a text 16 or 32 bytes at once (SSE2 or AVX2, chosen at runtime
+// by the CPU), a byte by byte loop is used on other platforms and for short tails
+class CharSet {
+public:
+    static constexpr size_t MAX_SIZE = 8;
+
+    // Up to MAX_SIZE chars, throws std::invalid_argument for more
+    explicit CharSet(std::string_view chars);
+
+    // Position of the first char of the set at or after the position, the text size if there is none
+    size_t FindIn(std::string_view text, size_t pos = 0) const;
+
+    bool Contains(char c) const;
+
+private:
+    std::array<char, MAX_SIZE> chars_{};
+    size_t size_ = 0;
+    std::array<bool, 256> table_{};
+};
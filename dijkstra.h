@@ -0,0 +1,261 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    inline constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    // Single-source shortest path tree stored as two flat rows indexed by VertexId
+    template <typename Weight>
+    struct ShortestPathTree {
+        static constexpr Weight UNREACHABLE = std::numeric_limits<Weight>::max();
+
+        VertexId source{};
+        std::vector<Weight> weights;
+        std::vector<EdgeId> prev_edges;
+
+        bool IsReached(VertexId vertex) const {
+            return weights[vertex] != UNREACHABLE;
+        }
+
+        size_t GetMemoryUsage() const {
+            return weights.capacity() * sizeof(Weight) + prev_edges.capacity() * sizeof(EdgeId);
+        }
+    };
+
+    // Stops as soon as all targets are settled, empty targets mean a full one-to-all search.
+    // Weights of vertices which were not settled before the stop are not final.
+    // Vertices farther than max_weight are left unreached
+    template <typename Weight>
+    ShortestPathTree<Weight> BuildShortestPathTree(const DirectedWeightedGraph<Weight>& graph, VertexId source,
+                                                   const std::vector<VertexId>& targets = {},
+                                                   Weight max_weight = ShortestPathTree<Weight>::UNREACHABLE) {
+        using namespace std::literals;
+
+        constexpr Weight ZERO_WEIGHT{};
+        const size_t vertex_count = graph.GetVertexCount();
+
+        std::vector<bool> is_unsettled_target(targets.empty() ? 0 : vertex_count, false);
+        size_t unsettled_targets_count = 0;
+
+        for (const VertexId target : targets) {
+            if (!is_unsettled_target.at(target)) {
+                is_unsettled_target[target] = true;
+                ++unsettled_targets_count;
+            }
+        }
+
+        ShortestPathTree<Weight> tree;
+        tree.source = source;
+        tree.weights.assign(vertex_count, ShortestPathTree<Weight>::UNREACHABLE);
+        tree.prev_edges.assign(vertex_count, NO_EDGE);
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>> queue;
+
+        tree.weights.at(source) = ZERO_WEIGHT;
+        queue.emplace(ZERO_WEIGHT, source);
+
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+
+            if (weight > tree.weights[vertex]) {
+                continue; // outdated queue item
+            }
+
+            if (!targets.empty() && is_unsettled_target[vertex]) {
+                is_unsettled_target[vertex] = false;
+
+                if (--unsettled_targets_count == 0) {
+                    break;
+                }
+            }
+
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative"s);
+                }
+
+                const Weight candidate_weight = weight + edge.weight;
+                if (candidate_weight > max_weight) {
+                    continue;
+                }
+
+                if (candidate_weight < tree.weights[edge.to]) {
+                    tree.weights[edge.to] = candidate_weight;
+                    tree.prev_edges[edge.to] = edge_id;
+                    queue.emplace(candidate_weight, edge.to);
+                }
+            }
+        }
+
+        return tree;
+    }
+
+    // A full tree stays valid after the graph change unless it uses a removed edge
+    // or one of the added edges shortens a path. The tree is given by rows of vertex_count items
+    template <typename Weight>
+    bool IsTreeAffected(const DirectedWeightedGraph<Weight>& graph, const Weight* weights, const EdgeId* prev_edges,
+                        const std::unordered_set<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) {
+        for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+            if (prev_edges[vertex] != NO_EDGE && removed_edges.count(prev_edges[vertex]) > 0) {
+                return true;
+            }
+        }
+
+        for (const EdgeId edge_id : added_edges) {
+            const auto& edge = graph.GetEdge(edge_id);
+
+            if (weights[edge.from] != ShortestPathTree<Weight>::UNREACHABLE
+                && weights[edge.from] + edge.weight < weights[edge.to]) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    template <typename Weight>
+    bool IsTreeAffected(const DirectedWeightedGraph<Weight>& graph, const ShortestPathTree<Weight>& tree,
+                        const std::unordered_set<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) {
+        return IsTreeAffected(graph, tree.weights.data(), tree.prev_edges.data(), removed_edges, added_edges);
+    }
+
+    template <typename Weight>
+    struct BestRouteInfo {
+        VertexId source{};
+        VertexId target{};
+        Weight weight{}; // including source and target offsets
+        std::vector<EdgeId> edges;
+    };
+
+    // Multi-source multi-target search: sources start with their offsets and a target costs its offset
+    // on arrival. Finishes as soon as no unsettled vertex can improve the best found target
+    template <typename Weight>
+    std::optional<BestRouteInfo<Weight>> FindBestRoute(const DirectedWeightedGraph<Weight>& graph,
+                                                       const std::vector<std::pair<VertexId, Weight>>& sources,
+                                                       const std::vector<std::pair<VertexId, Weight>>& targets) {
+        using namespace std::literals;
+
+        constexpr Weight ZERO_WEIGHT{};
+        constexpr Weight UNREACHABLE = ShortestPathTree<Weight>::UNREACHABLE;
+        const size_t vertex_count = graph.GetVertexCount();
+
+        ShortestPathTree<Weight> tree;
+        tree.weights.assign(vertex_count, UNREACHABLE);
+        tree.prev_edges.assign(vertex_count, NO_EDGE);
+
+        std::vector<Weight> target_offsets(vertex_count, UNREACHABLE);
+        for (const auto& [target, offset] : targets) {
+            target_offsets.at(target) = std::min(target_offsets[target], offset);
+        }
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>> queue;
+
+        for (const auto& [source, offset] : sources) {
+            if (offset < tree.weights.at(source)) {
+                tree.weights[source] = offset;
+                queue.emplace(offset, source);
+            }
+        }
+
+        Weight best_weight = UNREACHABLE;
+        VertexId best_target{};
+
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+
+            if (weight >= best_weight) {
+                break; // offsets are non-negative, so the rest can't be better
+            }
+
+            if (weight > tree.weights[vertex]) {
+                continue; // outdated queue item
+            }
+
+            if (target_offsets[vertex] != UNREACHABLE && weight + target_offsets[vertex] < best_weight) {
+                best_weight = weight + target_offsets[vertex];
+                best_target = vertex;
+            }
+
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative"s);
+                }
+
+                const Weight candidate_weight = weight + edge.weight;
+                if (candidate_weight < tree.weights[edge.to]) {
+                    tree.weights[edge.to] = candidate_weight;
+                    tree.prev_edges[edge.to] = edge_id;
+                    queue.emplace(candidate_weight, edge.to);
+                }
+            }
+        }
+
+        if (best_weight == UNREACHABLE) {
+            return std::nullopt;
+        }
+
+        BestRouteInfo<Weight> route;
+        route.target = best_target;
+        route.weight = best_weight;
+
+        // the route starts at the source where prev_edges chain ends
+        VertexId vertex = best_target;
+        for (EdgeId edge_id = tree.prev_edges[vertex]; edge_id != NO_EDGE; edge_id = tree.prev_edges[vertex]) {
+            route.edges.push_back(edge_id);
+            vertex = graph.GetEdge(edge_id).from;
+        }
+
+        route.source = vertex;
+        std::reverse(route.edges.begin(), route.edges.end());
+
+        return route;
+    }
+
+    // Walks prev_edges back from the target and returns the route in travel order
+    template <typename Weight>
+    std::optional<typename RouterBase<Weight>::RouteInfo> ExtractRoute(const DirectedWeightedGraph<Weight>& graph,
+                                                                       const Weight* weights,
+                                                                       const EdgeId* prev_edges, VertexId to) {
+        if (weights[to] == ShortestPathTree<Weight>::UNREACHABLE) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = prev_edges[to]; edge_id != NO_EDGE; edge_id = prev_edges[graph.GetEdge(edge_id).from]) {
+            edges.push_back(edge_id);
+        }
+
+        std::reverse(edges.begin(), edges.end());
+
+        return typename RouterBase<Weight>::RouteInfo{ weights[to], std::move(edges) };
+    }
+
+    template <typename Weight>
+    std::optional<typename RouterBase<Weight>::RouteInfo> ExtractRoute(const DirectedWeightedGraph<Weight>& graph,
+                                                                       const ShortestPathTree<Weight>& tree,
+                                                                       VertexId to) {
+        return ExtractRoute(graph, tree.weights.data(), tree.prev_edges.data(), to);
+    }
+
+} // namespace graph
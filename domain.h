@@ -1,10 +1,14 @@
 #pragma once
 
+#include "geo.h"
+
 #include <array>
 #include <deque>
-#include <set>
+#include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <variant>
+#include <vector>
 
 struct Stop {
     std::string name;
@@ -17,21 +21,83 @@ struct Bus {
     std::string name;
     std::deque<std::string> stops;
     bool is_roundtrip = false;
+    std::vector<double> departures; // from the first stop in minutes after midnight, optional
+};
+
+struct Road_Distance {
+    std::string from;
+    std::string to;
+    int distance{};
+};
+
+// Changes of the live transport base
+struct Transport_Update {
+    std::vector<Road_Distance> road_distances;
+    std::deque<Bus> add_buses; // a bus with an existing name replaces it
+    std::vector<std::string> remove_buses;
+};
+
+// Stat requests refer to stops of the catalogue, nullptr for unknown names.
+// Stops are never removed, buses are looked up by names since updates replace them
+struct Bus_Request {
+    int id{};
+    std::string name;
+};
+
+struct Stop_Request {
+    int id{};
+    const Stop* stop = nullptr;
+};
+
+struct Map_Request {
+    int id{};
 };
 
-enum class RequestType {
-    BUS,
-    STOP,
-    MAP,
-    ROUTE
-};  
+struct Route_Request {
+    int id{};
+    const Stop* from = nullptr;
+    const Stop* to = nullptr;
+    std::optional<int> bus_wait_time;   // replaces the base settings
+    std::optional<double> bus_velocity; // in meters per minute, replaces the base settings
+    std::optional<double> departure_time; // the route by bus timetables
+    bool total_time_only = false;
+    std::string_view settings_error; // the answer instead of a route if the settings are invalid
+
+    bool HasOwnSettings() const {
+        return bus_wait_time.has_value() || bus_velocity.has_value();
+    }
+};
+
+// Door-to-door route between arbitrary points
+struct Coordinates_Route_Request {
+    int id{};
+    geo::Coordinates from;
+    geo::Coordinates to;
+    bool total_time_only = false;
+    // "routing_settings" or "departure_time" were given, they are not supported between coordinates
+    bool has_unsupported_options = false;
+};
 
-struct Stat {
+struct Matrix_Request {
     int id{};
-    RequestType type;
-    std::unordered_map<std::string, std::string> key_values;
+    std::vector<const Stop*> sources;
+    std::vector<const Stop*> targets;
 };
 
+struct Isochrone_Request {
+    int id{};
+    const Stop* from = nullptr;
+    double time_budget{};
+};
+
+struct Update_Request {
+    int id{};
+    Transport_Update update;
+};
+
+using Stat = std::variant<Bus_Request, Stop_Request, Map_Request, Route_Request, Coordinates_Route_Request,
+                          Matrix_Request, Isochrone_Request, Update_Request>;
+
 struct Bus_Route_Stat {
     std::string bus_name;
     int stops_count{};
@@ -39,9 +105,3 @@ struct Bus_Route_Stat {
     double length{};
     double curvature{};
 };
-
-struct BusesToStop {
-    std::string stop_name;
-    bool notFound = true;
-    std::set<std::string_view> buses;
-};
@@ -2,6 +2,7 @@
 
 #include "ranges.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <vector>
 
@@ -28,6 +29,10 @@ namespace graph {
         explicit DirectedWeightedGraph(size_t vertex_count);
         EdgeId AddEdge(const Edge<Weight>& edge);
 
+        // The edge is detached from its vertex, its id is never reused
+        void RemoveEdge(EdgeId edge_id);
+        bool IsEdgeRemoved(EdgeId edge_id) const;
+
         size_t GetVertexCount() const;
         size_t GetEdgeCount() const;
         const Edge<Weight>& GetEdge(EdgeId edge_id) const;
@@ -36,6 +41,7 @@ namespace graph {
     private:
         std::vector<Edge<Weight>> edges_;
         std::vector<IncidenceList> incidence_lists_;
+        std::vector<bool> removed_edges_;
     };
 
     template <typename Weight>
@@ -46,12 +52,30 @@ namespace graph {
     template <typename Weight>
     EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
         edges_.push_back(edge);
+        removed_edges_.push_back(false);
         const EdgeId id = edges_.size() - 1;
         incidence_lists_.at(edge.from).push_back(id);
 
         return id;
     }
 
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::RemoveEdge(EdgeId edge_id) {
+        if (removed_edges_.at(edge_id)) {
+            return;
+        }
+
+        auto& incidence_list = incidence_lists_.at(edges_[edge_id].from);
+        incidence_list.erase(std::find(incidence_list.begin(), incidence_list.end(), edge_id));
+
+        removed_edges_[edge_id] = true;
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::IsEdgeRemoved(EdgeId edge_id) const {
+        return removed_edges_.at(edge_id);
+    }
+
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
         return incidence_lists_.size();
@@ -0,0 +1,347 @@
+#include "hub_labels.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string_view>
+
+using namespace std;
+
+namespace graph {
+
+    namespace {
+        constexpr double INF_WEIGHT = std::numeric_limits<double>::infinity();
+        constexpr std::string_view FILE_MAGIC = "HUBLBL01"sv;
+
+        using TmpLabel = std::vector<std::pair<uint32_t, double>>;
+
+        template <typename T>
+        void WriteValues(std::ostream& output, const T* values, size_t count) {
+            output.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+        }
+
+        template <typename T>
+        bool ReadValues(std::istream& input, T* values, size_t count) {
+            input.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+            return static_cast<bool>(input);
+        }
+
+        // Bytes left in the stream, none is known for a stream without positions
+        std::optional<uint64_t> GetRemainingSize(std::istream& input) {
+            const std::istream::pos_type pos = input.tellg();
+            if (pos == std::istream::pos_type(-1) || !input.seekg(0, std::ios::end)) {
+                input.clear();
+                return std::nullopt;
+            }
+
+            const std::istream::pos_type end = input.tellg();
+            input.seekg(pos);
+
+            if (end == std::istream::pos_type(-1) || !input || end < pos) {
+                return std::nullopt;
+            }
+
+            return static_cast<uint64_t>(end - pos);
+        }
+    } // namespace
+
+    HubLabels HubLabels::Build(const Graph& graph) {
+        const size_t vertex_count = graph.GetVertexCount();
+
+        std::vector<std::vector<EdgeId>> incoming_edges(vertex_count);
+        std::vector<size_t> out_degrees(vertex_count, 0);
+
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.IsEdgeRemoved(edge_id)) {
+                continue;
+            }
+
+            const auto& edge = graph.GetEdge(edge_id);
+
+            if (edge.weight < 0.0) {
+                throw std::domain_error("Edges' weights should be non-negative"s);
+            }
+
+            incoming_edges[edge.to].push_back(edge_id);
+            ++out_degrees[edge.from];
+        }
+
+        // the busiest vertices become hubs first, they cover the most shortest paths
+        std::vector<VertexId> order(vertex_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](VertexId lhs, VertexId rhs) {
+            return (incoming_edges[lhs].size() + 1) * (out_degrees[lhs] + 1)
+                   > (incoming_edges[rhs].size() + 1) * (out_degrees[rhs] + 1);
+        });
+
+        std::vector<TmpLabel> out_labels(vertex_count);
+        std::vector<TmpLabel> in_labels(vertex_count);
+
+        std::vector<double> weights(vertex_count, INF_WEIGHT);
+        std::vector<VertexId> touched;
+        std::vector<double> hub_weights(vertex_count, INF_WEIGHT); // label of the current hub indexed by rank
+
+        // Pruned search from the hub. Forward search fills in labels, backward one fills out labels.
+        // A vertex is pruned if already known hubs give the same or shorter distance
+        const auto pruned_search = [&](uint32_t rank, VertexId hub, bool is_forward) {
+            const TmpLabel& hub_label = is_forward ? out_labels[hub] : in_labels[hub];
+            for (const auto& [hub_rank, weight] : hub_label) {
+                hub_weights[hub_rank] = weight;
+            }
+
+            using QueueItem = std::pair<double, VertexId>;
+            std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>> queue;
+
+            weights[hub] = 0.0;
+            touched.push_back(hub);
+            queue.emplace(0.0, hub);
+
+            while (!queue.empty()) {
+                const auto [weight, vertex] = queue.top();
+                queue.pop();
+
+                if (weight > weights[vertex]) {
+                    continue; // outdated queue item
+                }
+
+                TmpLabel& vertex_label = is_forward ? in_labels[vertex] : out_labels[vertex];
+
+                const bool is_covered = std::any_of(vertex_label.begin(), vertex_label.end(), [&](const auto& item) {
+                    return hub_weights[item.first] + item.second <= weight;
+                });
+
+                if (is_covered) {
+                    continue;
+                }
+
+                vertex_label.emplace_back(rank, weight);
+
+                const auto relax = [&](EdgeId edge_id) {
+                    const auto& edge = graph.GetEdge(edge_id);
+                    const VertexId next = is_forward ? edge.to : edge.from;
+                    const double candidate_weight = weight + edge.weight;
+
+                    if (candidate_weight < weights[next]) {
+                        if (weights[next] == INF_WEIGHT) {
+                            touched.push_back(next);
+                        }
+
+                        weights[next] = candidate_weight;
+                        queue.emplace(candidate_weight, next);
+                    }
+                };
+
+                if (is_forward) {
+                    for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                        relax(edge_id);
+                    }
+                } else {
+                    for (const EdgeId edge_id : incoming_edges[vertex]) {
+                        relax(edge_id);
+                    }
+                }
+            }
+
+            for (VertexId vertex : touched) {
+                weights[vertex] = INF_WEIGHT;
+            }
+            touched.clear();
+
+            for (const auto& [hub_rank, weight] : hub_label) {
+                hub_weights[hub_rank] = INF_WEIGHT;
+            }
+        };
+
+        for (uint32_t rank = 0; rank < vertex_count; ++rank) {
+            pruned_search(rank, order[rank], true);
+            pruned_search(rank, order[rank], false);
+        }
+
+        const auto flatten = [vertex_count](const std::vector<TmpLabel>& tmp_labels, Labels& labels) {
+            labels.offsets.assign(vertex_count + 1, 0);
+
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                labels.offsets[vertex + 1] = labels.offsets[vertex] + static_cast<uint32_t>(tmp_labels[vertex].size());
+
+                for (const auto& [hub_rank, weight] : tmp_labels[vertex]) {
+                    labels.hubs.push_back(hub_rank);
+                    labels.weights.push_back(weight);
+                }
+            }
+        };
+
+        HubLabels hub_labels;
+        hub_labels.graph_checksum_ = GetGraphChecksum(graph);
+        flatten(out_labels, hub_labels.out_labels_);
+        flatten(in_labels, hub_labels.in_labels_);
+
+        return hub_labels;
+    }
+
+    std::optional<double> HubLabels::GetWeight(VertexId from, VertexId to) const {
+        uint32_t out_pos = out_labels_.offsets.at(from);
+        const uint32_t out_end = out_labels_.offsets.at(from + 1);
+        uint32_t in_pos = in_labels_.offsets.at(to);
+        const uint32_t in_end = in_labels_.offsets.at(to + 1);
+
+        double best_weight = INF_WEIGHT;
+
+        // both labels are sorted by hub rank
+        while (out_pos < out_end && in_pos < in_end) {
+            const uint32_t out_hub = out_labels_.hubs[out_pos];
+            const uint32_t in_hub = in_labels_.hubs[in_pos];
+
+            if (out_hub == in_hub) {
+                best_weight = std::min(best_weight, out_labels_.weights[out_pos] + in_labels_.weights[in_pos]);
+                ++out_pos;
+                ++in_pos;
+            } else if (out_hub < in_hub) {
+                ++out_pos;
+            } else {
+                ++in_pos;
+            }
+        }
+
+        if (best_weight == INF_WEIGHT) {
+            return std::nullopt;
+        }
+
+        return best_weight;
+    }
+
+    size_t HubLabels::GetLabelsSize() const {
+        return out_labels_.hubs.size() + in_labels_.hubs.size();
+    }
+
+    uint64_t HubLabels::GetGraphChecksum(const Graph& graph) {
+        // FNV-1a over the edges
+        uint64_t checksum = 14695981039346656037ULL;
+
+        const auto add = [&checksum](const void* data, size_t size) {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                checksum = (checksum ^ bytes[i]) * 1099511628211ULL;
+            }
+        };
+
+        const uint64_t vertex_count = graph.GetVertexCount();
+        add(&vertex_count, sizeof(vertex_count));
+
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.IsEdgeRemoved(edge_id)) {
+                continue;
+            }
+
+            const auto& edge = graph.GetEdge(edge_id);
+            const uint64_t from = edge.from;
+            const uint64_t to = edge.to;
+
+            add(&from, sizeof(from));
+            add(&to, sizeof(to));
+            add(&edge.weight, sizeof(edge.weight));
+        }
+
+        return checksum;
+    }
+
+    void HubLabels::Save(std::ostream& output) const {
+        output.write(FILE_MAGIC.data(), static_cast<std::streamsize>(FILE_MAGIC.size()));
+
+        const uint64_t vertex_count = out_labels_.offsets.size() - 1;
+        WriteValues(output, &vertex_count, 1);
+        WriteValues(output, &graph_checksum_, 1);
+
+        SaveLabels(out_labels_, output);
+        SaveLabels(in_labels_, output);
+    }
+
+    void HubLabels::SaveLabels(const Labels& labels, std::ostream& output) {
+        const uint64_t hubs_count = labels.hubs.size();
+
+        WriteValues(output, &hubs_count, 1);
+        WriteValues(output, labels.offsets.data(), labels.offsets.size());
+        WriteValues(output, labels.hubs.data(), labels.hubs.size());
+        WriteValues(output, labels.weights.data(), labels.weights.size());
+    }
+
+    std::optional<HubLabels> HubLabels::Load(std::istream& input, const Graph& graph) {
+        char magic[FILE_MAGIC.size()];
+        if (!ReadValues(input, magic, FILE_MAGIC.size()) || std::string_view(magic, FILE_MAGIC.size()) != FILE_MAGIC) {
+            return std::nullopt;
+        }
+
+        uint64_t vertex_count = 0;
+        HubLabels hub_labels;
+
+        if (!ReadValues(input, &vertex_count, 1) || !ReadValues(input, &hub_labels.graph_checksum_, 1)) {
+            return std::nullopt;
+        }
+
+        if (vertex_count != graph.GetVertexCount() || hub_labels.graph_checksum_ != GetGraphChecksum(graph)) {
+            return std::nullopt;
+        }
+
+        if (!LoadLabels(hub_labels.out_labels_, input, vertex_count)
+            || !LoadLabels(hub_labels.in_labels_, input, vertex_count)) {
+            return std::nullopt;
+        }
+
+        return hub_labels;
+    }
+
+    bool HubLabels::LoadLabels(Labels& labels, std::istream& input, size_t vertex_count) {
+        uint64_t hubs_count = 0;
+        if (!ReadValues(input, &hubs_count, 1)) {
+            return false;
+        }
+
+        // a damaged count must not reach the allocation: a label has at most every vertex as a hub
+        // and the file has to hold the offsets, the hubs and the weights
+        if (vertex_count > 0 && hubs_count / vertex_count > vertex_count) {
+            return false;
+        }
+
+        const uint64_t labels_size = (vertex_count + 1) * sizeof(uint32_t) + hubs_count * (sizeof(uint32_t) + sizeof(double));
+        if (const auto remaining_size = GetRemainingSize(input); remaining_size && *remaining_size < labels_size) {
+            return false;
+        }
+
+        labels.offsets.resize(vertex_count + 1);
+        labels.hubs.resize(hubs_count);
+        labels.weights.resize(hubs_count);
+
+        if (!ReadValues(input, labels.offsets.data(), labels.offsets.size())
+            || !ReadValues(input, labels.hubs.data(), labels.hubs.size())
+            || !ReadValues(input, labels.weights.data(), labels.weights.size())) {
+            return false;
+        }
+
+        if (labels.offsets.front() != 0 || labels.offsets.back() != hubs_count) {
+            return false;
+        }
+
+        // queries merge labels by hub ids and index the hubs by offsets
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+            const uint32_t begin = labels.offsets[vertex];
+            const uint32_t end = labels.offsets[vertex + 1];
+
+            if (begin > end) {
+                return false;
+            }
+
+            for (uint32_t pos = begin; pos < end; ++pos) {
+                if (labels.hubs[pos] >= vertex_count || (pos > begin && labels.hubs[pos - 1] >= labels.hubs[pos])
+                    || !(labels.weights[pos] >= 0.0)) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+} // namespace graph
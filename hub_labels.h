@@ -0,0 +1,52 @@
+#pragma once
+
+#include "graph.h"
+
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace graph {
+
+    /*
+    Hub labeling distance oracle. Every vertex keeps a short list of hubs with distances
+    to them (out label) and from them (in label) so that any shortest path goes through a hub
+    common to both labels. A route weight is a merge of two lists sorted by hub rank.
+    Labels are built by pruned Dijkstra searches from vertices in the order of their importance.
+    */
+    class HubLabels {
+    public:
+        using Graph = DirectedWeightedGraph<double>;
+
+        static HubLabels Build(const Graph& graph);
+
+        // Returns std::nullopt if data is damaged or was built for another graph
+        static std::optional<HubLabels> Load(std::istream& input, const Graph& graph);
+        void Save(std::ostream& output) const;
+
+        std::optional<double> GetWeight(VertexId from, VertexId to) const;
+
+        size_t GetLabelsSize() const;
+
+    private:
+        // Hubs of a label are sorted by rank
+        struct Labels {
+            std::vector<uint32_t> offsets; // of every vertex label, vertex_count + 1 items
+            std::vector<uint32_t> hubs;
+            std::vector<double> weights;
+        };
+
+        HubLabels() = default;
+
+        static uint64_t GetGraphChecksum(const Graph& graph);
+        static void SaveLabels(const Labels& labels, std::ostream& output);
+        static bool LoadLabels(Labels& labels, std::istream& input, size_t vertex_count);
+
+    private:
+        uint64_t graph_checksum_{};
+        Labels out_labels_;
+        Labels in_labels_;
+    };
+
+} // namespace graph
@@ -1,14 +1,17 @@
 #include "json.h"
+#include "char_set.h"
 
+#include <charconv>
 #include <iterator>
+#include <sstream>
 
 namespace json {
 
     namespace {
         using namespace std::literals;
 
-        Node LoadNode(std::istream& input);
-        Node LoadString(std::istream& input);
+        Node LoadNode(std::istream& input, std::pmr::memory_resource* resource);
+        String LoadString(std::istream& input, std::pmr::memory_resource* resource);
 
         std::string LoadLiteral(std::istream& input) {
 
@@ -20,36 +23,36 @@ namespace json {
             return str;
         }
 
-        Node LoadArray(std::istream& input) {
+        Node LoadArray(std::istream& input, std::pmr::memory_resource* resource) {
 
-            std::vector<Node> result;
+            Array result(resource);
             for (char current_char; input >> current_char && current_char != ']';) {
                 if (current_char != ',') {
                     input.putback(current_char);
                 }
-                result.push_back(LoadNode(input));
+                result.push_back(LoadNode(input, resource));
             }
 
             if (!input) {
                 throw ParsingError("Array parsing error"s);
             }
 
-            return result;
+            return Node{ std::move(result) };
         }
 
-        Node LoadDict(std::istream& input) {
+        Node LoadDict(std::istream& input, std::pmr::memory_resource* resource) {
 
-            Dict dict;
+            Dict dict(resource);
             for (char current_char; input >> current_char && current_char != '}';) {
                 if (current_char == '"') {
-                    std::string key = LoadString(input).AsString();
+                    String key = LoadString(input, resource);
 
                     if (input >> current_char && current_char == ':') {
                         if (dict.find(key) != dict.end()) {
-                            throw ParsingError("Duplicate key '"s + key + "' have been found");
+                            throw ParsingError("Duplicate key '"s + std::string(key) + "' have been found");
                         }
 
-                        dict.emplace(std::move(key), LoadNode(input));
+                        dict.emplace(std::move(key), LoadNode(input, resource));
                     } else {
                         throw ParsingError(": is expected but '"s + current_char + "' has been found"s);
                     }
@@ -62,14 +65,14 @@ namespace json {
                 throw ParsingError("Dictionary parsing error"s);
             }
 
-            return dict;
+            return Node{ std::move(dict) };
         }
 
-        Node LoadString(std::istream& input) {
+        String LoadString(std::istream& input, std::pmr::memory_resource* resource) {
             auto it = std::istreambuf_iterator<char>(input);
             auto end = std::istreambuf_iterator<char>();
 
-            std::string str;
+            String str(resource);
             while (true) {
                 if (it == end) {
                     throw ParsingError("String parsing error");
@@ -194,7 +197,7 @@ namespace json {
             }
         }
 
-        Node LoadNode(std::istream& input) {
+        Node LoadNode(std::istream& input, std::pmr::memory_resource* resource) {
 
             char current_char;
             if (!(input >> current_char)) {
@@ -202,11 +205,11 @@ namespace json {
             }
             switch (current_char) {
             case '[':
-                return LoadArray(input);
+                return LoadArray(input, resource);
             case '{':
-                return LoadDict(input);
+                return LoadDict(input, resource);
             case '"':
-                return LoadString(input);
+                return Node{ LoadString(input, resource) };
             case 't': case 'f':
                 input.putback(current_char);
                 return LoadBool(input);
@@ -220,16 +223,33 @@ namespace json {
         }
 
         struct PrintContext {
-            std::ostream& out;
+            OutputBuffer& out;
             int indent_step = 4;
             int indent = 0;
 
             void PrintIndent() const {
-                for (int i = 0; i < indent; ++i) {
-                    out.put(' ');
+                if (!out.GetOptions().compact) {
+                    out.Put(' ', static_cast<size_t>(indent));
+                }
+            }
+
+            void PrintLineBreak() const {
+                if (!out.GetOptions().compact) {
+                    out.Put('\n');
                 }
             }
 
+            // between items of a container
+            void PrintSeparator() const {
+                out.Put(',');
+                PrintLineBreak();
+            }
+
+            void PrintKey(std::string_view key) const {
+                out.WriteString(key);
+                out.Write(out.GetOptions().compact ? ":"sv : ": "sv);
+            }
+
             PrintContext Indented() const {
                 return { out, indent_step, indent_step + indent };
             }
@@ -237,55 +257,31 @@ namespace json {
 
         void PrintNode(const Node& node, const PrintContext& ctx);
 
-        template <typename Value>
-        void PrintValue(const Value& value, const PrintContext& ctx) {
-            ctx.out << value;
+        void PrintValue(std::nullptr_t, const PrintContext& ctx) {
+            ctx.out.Write("null"sv);
         }
 
-        void PrintString(const std::string& value, std::ostream& out) {
-            out.put('"');
-            for (const char current_char : value) {
-                switch (current_char) {
-                case '\r':
-                    out << "\\r"sv;
-                    break;
-                case '\n':
-                    out << "\\n"sv;
-                    break;
-                case '"':
-                    out << "\\\""sv;
-                    break;
-                case '\\':
-                    out << "\\\\"sv;
-                    break;
-                default:
-                    out.put(current_char);
-                    break;
-                }
-            }
-            out.put('"');
+        void PrintValue(bool value, const PrintContext& ctx) {
+            ctx.out.Write(value ? "true"sv : "false"sv);
         }
 
-        template <>
-        void PrintValue<std::string>(const std::string& value, const PrintContext& ctx) {
-            PrintString(value, ctx.out);
+        void PrintValue(int value, const PrintContext& ctx) {
+            ctx.out.WriteInt(value);
         }
 
-        template <>
-        void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
-            ctx.out << "null"sv;
+        void PrintValue(double value, const PrintContext& ctx) {
+            ctx.out.WriteDouble(value);
         }
 
-        template <>
-        void PrintValue<bool>(const bool& value, const PrintContext& ctx) {
-            ctx.out << (value ? "true"sv : "false"sv);
+        void PrintValue(const String& value, const PrintContext& ctx) {
+            ctx.out.WriteString(value);
         }
 
-        template <>
-        void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
-            std::ostream& out = ctx.out;
+        void PrintValue(const Array& nodes, const PrintContext& ctx) {
+            OutputBuffer& out = ctx.out;
 
-            out << "[\n"sv;
+            out.Put('[');
+            ctx.PrintLineBreak();
 
             bool first = true;
             auto inner_ctx = ctx.Indented();
@@ -293,23 +289,23 @@ namespace json {
                 if (first) {
                     first = false;
                 } else {
-                    out << ",\n"sv;
+                    ctx.PrintSeparator();
                 }
 
                 inner_ctx.PrintIndent();
                 PrintNode(node, inner_ctx);
             }
 
-            out.put('\n');
+            ctx.PrintLineBreak();
             ctx.PrintIndent();
-            out.put(']');
+            out.Put(']');
         }
 
-        template <>
-        void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
-            std::ostream& out = ctx.out;
+        void PrintValue(const Dict& nodes, const PrintContext& ctx) {
+            OutputBuffer& out = ctx.out;
 
-            out << "{\n"sv;
+            out.Put('{');
+            ctx.PrintLineBreak();
 
             bool first = true;
             auto inner_ctx = ctx.Indented();
@@ -317,18 +313,25 @@ namespace json {
                 if (first) {
                     first = false;
                 } else {
-                    out << ",\n"sv;
+                    ctx.PrintSeparator();
                 }
 
                 inner_ctx.PrintIndent();
-                PrintString(key, ctx.out);
-                out << ": "sv;
+                ctx.PrintKey(key);
                 PrintNode(node, inner_ctx);
             }
 
-            out.put('\n');
+            ctx.PrintLineBreak();
             ctx.PrintIndent();
-            out.put('}');
+            out.Put('}');
+        }
+
+        // Context of values nested into the number of containers
+        PrintContext GetNestedContext(OutputBuffer& out, size_t depth) {
+            PrintContext ctx{ out };
+            ctx.indent = ctx.indent_step * static_cast<int>(depth);
+
+            return ctx;
         }
 
         void PrintNode(const Node& node, const PrintContext& ctx) {
@@ -339,14 +342,272 @@ namespace json {
                 node.GetValue());
         }
 
+        // Escape sequence of a char, nothing if it is printed as is
+        std::string_view GetEscapeSequence(char current_char) {
+            switch (current_char) {
+            case '\r':
+                return "\\r"sv;
+            case '\n':
+                return "\\n"sv;
+            case '"':
+                return "\\\""sv;
+            case '\\':
+                return "\\\\"sv;
+            default:
+                return {};
+            }
+        }
+
+        // Position of the first char to escape from the position, or the size
+        size_t FindEscapedChar(std::string_view text, size_t pos) {
+            static const CharSet escaped_chars("\r\n\"\\"sv);
+
+            return escaped_chars.FindIn(text, pos);
+        }
+
     } // namespace
 
-    Document Load(std::istream& input) {
-        return Document{ LoadNode(input) };
+    Document Load(std::istream& input, std::pmr::memory_resource* resource) {
+        return Document{ LoadNode(input, resource) };
+    }
+
+    OutputBuffer::OutputBuffer(std::ostream& output, PrintOptions options)
+        : output_(output)
+        , options_(options)
+        , precision_(static_cast<int>(output.precision())) {
+        buffer_.reserve(BUFFER_SIZE);
+    }
+
+    OutputBuffer::~OutputBuffer() {
+        Flush();
+    }
+
+    void OutputBuffer::Put(char c) {
+        buffer_.push_back(c);
+        FlushIfFull();
+    }
+
+    void OutputBuffer::Put(char c, size_t count) {
+        buffer_.append(count, c);
+        FlushIfFull();
+    }
+
+    void OutputBuffer::Write(std::string_view text) {
+        buffer_.append(text);
+        FlushIfFull();
+    }
+
+    void OutputBuffer::WriteInt(int value) {
+        char chars[16];
+        const auto [end, error] = std::to_chars(std::begin(chars), std::end(chars), value);
+
+        Write({ chars, static_cast<size_t>(end - chars) });
+    }
+
+    void OutputBuffer::WriteDouble(double value) {
+        char chars[64];
+        const auto [end, error] = options_.shortest_doubles
+                                      ? std::to_chars(std::begin(chars), std::end(chars), value)
+                                      : std::to_chars(std::begin(chars), std::end(chars), value,
+                                                      std::chars_format::general, precision_);
+
+        if (error == std::errc{}) {
+            Write({ chars, static_cast<size_t>(end - chars) });
+            return;
+        }
+
+        // a very high precision doesn't fit
+        std::ostringstream stream;
+        stream.precision(precision_);
+        stream << value;
+        Write(stream.str());
+    }
+
+    void OutputBuffer::WriteString(std::string_view value) {
+        Put('"');
+
+        // runs without escapes are copied as a whole
+        for (size_t pos = 0; pos < value.size();) {
+            const size_t escaped_pos = FindEscapedChar(value, pos);
+            Write(value.substr(pos, escaped_pos - pos));
+
+            if (escaped_pos == value.size()) {
+                break;
+            }
+
+            Write(GetEscapeSequence(value[escaped_pos]));
+            pos = escaped_pos + 1;
+        }
+
+        Put('"');
+    }
+
+    void OutputBuffer::Flush() {
+        output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+
+    const PrintOptions& OutputBuffer::GetOptions() const {
+        return options_;
+    }
+
+    void OutputBuffer::FlushIfFull() {
+        if (buffer_.size() >= BUFFER_SIZE) {
+            Flush();
+        }
+    }
+
+    void Print(const Document& doc, std::ostream& output, PrintOptions options) {
+        OutputBuffer buffer(output, options);
+        PrintNode(doc.GetRoot(), PrintContext{ buffer });
+    }
+
+    Writer::Writer(std::ostream& output, PrintOptions options, size_t depth)
+        : output_(output)
+        , buffer_(output, options)
+        , depth_(depth) {
+    }
+
+    Writer& Writer::StartArray() {
+        StartValue();
+        buffer_.Put('[');
+        GetNestedContext(buffer_, GetDepth()).PrintLineBreak();
+        containers_.push_back({ false });
+
+        return *this;
+    }
+
+    Writer& Writer::EndArray() {
+        containers_.pop_back();
+
+        const PrintContext ctx = GetNestedContext(buffer_, GetDepth());
+        ctx.PrintLineBreak();
+        ctx.PrintIndent();
+        buffer_.Put(']');
+
+        return *this;
+    }
+
+    Writer& Writer::StartDict() {
+        StartValue();
+        buffer_.Put('{');
+        GetNestedContext(buffer_, GetDepth()).PrintLineBreak();
+        containers_.push_back({ true });
+
+        return *this;
+    }
+
+    Writer& Writer::Key(std::string_view key) {
+        Container& container = containers_.back();
+        const PrintContext ctx = GetNestedContext(buffer_, GetDepth());
+
+        if (!container.is_empty) {
+            ctx.PrintSeparator();
+        }
+        container.is_empty = false;
+
+        ctx.PrintIndent();
+        ctx.PrintKey(key);
+
+        return *this;
+    }
+
+    Writer& Writer::EndDict() {
+        containers_.pop_back();
+
+        const PrintContext ctx = GetNestedContext(buffer_, GetDepth());
+        ctx.PrintLineBreak();
+        ctx.PrintIndent();
+        buffer_.Put('}');
+
+        return *this;
+    }
+
+    Writer& Writer::Value(const Node& node) {
+        StartValue();
+        PrintNode(node, GetNestedContext(buffer_, GetDepth()));
+
+        return *this;
+    }
+
+    Writer& Writer::Value(std::nullptr_t) {
+        StartValue();
+        buffer_.Write("null"sv);
+
+        return *this;
     }
 
-    void Print(const Document& doc, std::ostream& output) {
-        PrintNode(doc.GetRoot(), PrintContext{ output });
+    Writer& Writer::Value(bool value) {
+        StartValue();
+        buffer_.Write(value ? "true"sv : "false"sv);
+
+        return *this;
+    }
+
+    Writer& Writer::Value(int value) {
+        StartValue();
+        buffer_.WriteInt(value);
+
+        return *this;
+    }
+
+    Writer& Writer::Value(double value) {
+        StartValue();
+        buffer_.WriteDouble(value);
+
+        return *this;
+    }
+
+    Writer& Writer::Value(std::string_view value) {
+        StartValue();
+        buffer_.WriteString(value);
+
+        return *this;
+    }
+
+    Writer& Writer::Value(const char* value) {
+        return Value(std::string_view(value));
+    }
+
+    Writer& Writer::Value(const std::string& value) {
+        return Value(std::string_view(value));
+    }
+
+    Writer& Writer::RawValue(std::string_view text) {
+        StartValue();
+        buffer_.Write(text);
+
+        return *this;
+    }
+
+    void Writer::Flush() {
+        buffer_.Flush();
+        output_.flush();
+    }
+
+    const PrintOptions& Writer::GetOptions() const {
+        return buffer_.GetOptions();
+    }
+
+    size_t Writer::GetDepth() const {
+        return depth_ + containers_.size();
+    }
+
+    void Writer::StartValue() {
+        // a dict value follows its key on the same line
+        if (containers_.empty() || containers_.back().is_dict) {
+            return;
+        }
+
+        Container& container = containers_.back();
+        const PrintContext ctx = GetNestedContext(buffer_, GetDepth());
+
+        if (!container.is_empty) {
+            ctx.PrintSeparator();
+        }
+        container.is_empty = false;
+
+        ctx.PrintIndent();
     }
 
 } // namespace json
\ No newline at end of file
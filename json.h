@@ -2,15 +2,22 @@
 
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
 namespace json {
 
     class Node;
-    using Dict = std::map<std::string, Node>;
-    using Array = std::vector<Node>;
+    // Containers and strings take a memory resource, so a whole document may live in one arena.
+    // A copy uses the default resource, a move keeps the resource of the source.
+    // Keys are looked up by any string type
+    using String = std::pmr::string;
+    using Dict = std::pmr::map<String, Node, std::less<>>;
+    using Array = std::pmr::vector<Node>;
 
     class ParsingError : public std::runtime_error {
     public:
@@ -18,7 +25,7 @@ namespace json {
     };
 
     class Node final
-        : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+        : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, String> {
     public:
         using variant::variant;
         using Value = variant;
@@ -83,17 +90,18 @@ namespace json {
         }
 
         bool IsString() const {
-            return std::holds_alternative<std::string>(*this);
+            return std::holds_alternative<String>(*this);
         }
 
-        const std::string& AsString() const {
+        // The view lives as long as the node
+        std::string_view AsString() const {
             using namespace std::literals;
 
             if (!IsString()) {
                 throw std::logic_error("Not a string"s);
             }
 
-            return std::get<std::string>(*this);
+            return std::get<String>(*this);
         }
 
         bool IsDict() const {
@@ -119,6 +127,9 @@ namespace json {
         }
     };
 
+    // arrays relocate nodes by move only if it can't throw, a copy would leave the arena
+    static_assert(std::is_nothrow_move_constructible_v<Node>);
+
     inline bool operator!=(const Node& lhs, const Node& rhs) {
         return !(lhs == rhs);
     }
@@ -145,8 +156,99 @@ namespace json {
         return !(lhs == rhs);
     }
 
-    Document Load(std::istream& input);
+    // Containers of the document are allocated from the resource, which should outlive the document
+    Document Load(std::istream& input, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    struct PrintOptions {
+        bool compact = false;          // without line breaks and indents
+        bool shortest_doubles = false; // the shortest form read back to the same value instead of the stream precision
+    };
+
+    // Output of the printer: text is collected and passed to the stream in large blocks,
+    // numbers are formatted by std::to_chars as the stream with default flags would do
+    class OutputBuffer {
+    public:
+        explicit OutputBuffer(std::ostream& output, PrintOptions options = {});
+        ~OutputBuffer();
+
+        OutputBuffer(const OutputBuffer&) = delete;
+        OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+        void Put(char c);
+        void Put(char c, size_t count);
+        void Write(std::string_view text);
+        void WriteInt(int value);
+        void WriteDouble(double value);
+        void WriteString(std::string_view value); // quoted and escaped
+
+        // Passes the collected text to the stream, the stream itself is not flushed
+        void Flush();
+
+        const PrintOptions& GetOptions() const;
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+        void FlushIfFull();
+
+    private:
+        std::ostream& output_;
+        PrintOptions options_;
+        int precision_;
+        std::string buffer_;
+    };
+
+    void Print(const Document& doc, std::ostream& output, PrintOptions options = {});
+
+    /*
+    Prints values one by one exactly as Print does for the document they make up, without building nodes.
+    Dict keys should be written in the order of Print, that is sorted.
+    Output is flushed on demand, so a finished part may be sent before the rest is ready
+    */
+    class Writer {
+    public:
+        // Values of a nested writer are printed as items of the depth containers of another one
+        explicit Writer(std::ostream& output, PrintOptions options = {}, size_t depth = 0);
+
+        Writer& StartArray();
+        Writer& EndArray();
+
+        Writer& StartDict();
+        Writer& Key(std::string_view key);
+        Writer& EndDict();
+
+        Writer& Value(const Node& node);
+        Writer& Value(std::nullptr_t);
+        Writer& Value(bool value);
+        Writer& Value(int value);
+        Writer& Value(double value);
+        Writer& Value(std::string_view value);
+        Writer& Value(const char* value);
+        Writer& Value(const std::string& value);
+
+        // A value printed by a writer nested into the current depth, it is put as is
+        Writer& RawValue(std::string_view text);
+
+        void Flush();
 
-    void Print(const Document& doc, std::ostream& output);
+        const PrintOptions& GetOptions() const;
+
+    private:
+        struct Container {
+            bool is_dict = false;
+            bool is_empty = true;
+        };
+
+        // separator and indent of an array item
+        void StartValue();
+
+        size_t GetDepth() const;
+
+    private:
+        std::ostream& output_;
+        OutputBuffer buffer_;
+        size_t depth_;
+        std::vector<Container> containers_;
+    };
 
 } // namespace json
\ No newline at end of file
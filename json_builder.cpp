@@ -4,7 +4,7 @@ namespace json {
     using namespace std::string_literals;
 
     // --- DictItemContext ---
-    KeyContext& DictItemContext::Key(const std::string& key) {
+    KeyContext& DictItemContext::Key(std::string_view key) {
         return builder_.Key(key);
     }
 
@@ -22,8 +22,8 @@ namespace json {
     }
 
     // --- StartArrayContext ---
-    StartArrayContext& StartArrayContext::Value(const Node::Value& value) {
-        builder_.CreateNode(value, !IS_MARKER);
+    StartArrayContext& StartArrayContext::Value(Node value) {
+        builder_.Value(std::move(value));
 
         return *this;
     }
@@ -33,137 +33,121 @@ namespace json {
     }
 
     // --- KeyContext ---
-    DictItemContext& KeyContext::Value(const Node::Value& value) {
-        return builder_.Value(value);
+    DictItemContext& KeyContext::Value(Node value) {
+        return builder_.Value(std::move(value));
     }
 
     // --- Builder ---
-    void Builder::CreateNode(const Node::Value& value, bool is_marker) {
-        auto lambdaNodeCreator = [this, is_marker](auto&& value) {
-            m_nodes_stack_.emplace_back(SNode{ std::make_unique<Node>(value), is_marker });
-        };
-        std::visit(lambdaNodeCreator, value);
-    }
+    void Builder::AddNode(Node&& node) {
+        if (frames_.empty()) {
+            if (root_) {
+                throw std::logic_error("Node is already compleated..."s);
+            }
 
-    DictItemContext& Builder::StartDict() {
-        Builder::CreateNode(Dict(), IS_MARKER);
+            root_ = std::move(node);
+            return;
+        }
 
-        return *this;
-    }
+        Frame& frame = frames_.back();
 
-    Builder& Builder::EndDict() {
-        Builder::CheckIfOblectCompleated();
+        if (!frame.is_dict) {
+            frame.array.push_back(std::move(node));
+            return;
+        }
 
-        std::stack<std::pair<std::string, u_ptr_Node>> tmp_key_value_stack;
+        if (!frame.key) {
+            throw std::logic_error("Called Value() without Key()..."s);
+        }
 
-        while (!(m_nodes_stack_.back().is_marker && m_nodes_stack_.back().u_ptr->IsDict())) {
-            u_ptr_Node value = std::move(m_nodes_stack_.back().u_ptr);
-            m_nodes_stack_.pop_back();
+        frame.dict.insert_or_assign(std::move(*frame.key), std::move(node));
+        frame.key.reset();
+    }
 
-            if (m_nodes_stack_.empty()) {
-                throw std::logic_error("No StartDict() or StartArray() was found..."s);
-            }
+    Builder::Frame& Builder::GetTopFrame(bool is_dict, const char* method) {
+        if (frames_.empty() || frames_.back().is_dict != is_dict) {
+            throw std::logic_error("Called "s + method + " without StartDict() or StartArray()..."s);
+        }
 
-            if (!m_nodes_stack_.back().u_ptr->IsString()) {
-                throw std::logic_error("No StartDict() or StartArray() was found..."s);
-            }
+        return frames_.back();
+    }
 
-            std::string key = m_nodes_stack_.back().u_ptr->AsString();
-            m_nodes_stack_.pop_back();
+    DictItemContext& Builder::StartDict() {
+        if (frames_.empty() && root_) {
+            throw std::logic_error("Node is already compleated..."s);
+        }
 
-            tmp_key_value_stack.emplace(std::move(key), std::move(value));
+        frames_.emplace_back(resource_, true);
 
-            if (m_nodes_stack_.empty()) {
-                throw std::logic_error("No StartDict() or StartArray() was found..."s);
-            }
-        }
+        return *this;
+    }
 
-        m_nodes_stack_.pop_back(); // delete Dict() marker
+    Builder& Builder::EndDict() {
+        Frame& frame = GetTopFrame(true, "EndDict()");
 
-        Dict tmp_dict; // generate new temp Dict
-        while (!tmp_key_value_stack.empty()) {
-            tmp_dict[tmp_key_value_stack.top().first] = std::move(*(tmp_key_value_stack.top().second));
-            tmp_key_value_stack.pop();
+        if (frame.key) {
+            throw std::logic_error("Called EndDict() after Key()..."s);
         }
 
-        Builder::CreateNode(tmp_dict, !IS_MARKER);
+        Dict dict = std::move(frame.dict);
+        frames_.pop_back();
+
+        AddNode(Node{ std::move(dict) });
 
         return *this;
     }
 
-    KeyContext& Builder::Key(const std::string& key) {
-        if (m_nodes_stack_.back().is_marker && !m_nodes_stack_.back().u_ptr->IsDict()) {
-            throw std::logic_error("Called Key() not after Dict()..."s);
+    KeyContext& Builder::Key(std::string_view key) {
+        Frame& frame = GetTopFrame(true, "Key()");
+
+        if (frame.key) {
+            throw std::logic_error("Called Key() after Key()..."s);
         }
 
-        Builder::CreateNode(key, IS_MARKER); //  do not put here '!'
+        frame.key.emplace(key, resource_);
 
         return *this;
     }
 
-    Builder& Builder::Value(const Node::Value& value) {
-        Builder::CheckIfOblectCompleated();
-
-        Builder::CreateNode(value, !IS_MARKER);
+    Builder& Builder::Value(Node value) {
+        AddNode(std::move(value));
 
         return *this;
     }
 
     StartArrayContext& Builder::StartArray() {
-        Builder::CreateNode(Array(), IS_MARKER);
+        if (frames_.empty() && root_) {
+            throw std::logic_error("Node is already compleated..."s);
+        }
+
+        frames_.emplace_back(resource_, false);
 
         return *this;
     }
 
     Builder& Builder::EndArray() {
-        Builder::CheckIfOblectCompleated();
-
-        std::stack<u_ptr_Node> tmp_nodes_stack;
-
-        while (!(m_nodes_stack_.back().is_marker && m_nodes_stack_.back().u_ptr->IsArray())) {
-            tmp_nodes_stack.push(std::move(m_nodes_stack_.back().u_ptr));
-            m_nodes_stack_.pop_back();
-
-            if (m_nodes_stack_.empty()) {
-                throw std::logic_error("No StartDict() or StartArray() was found..."s);
-            }
-        }
+        Frame& frame = GetTopFrame(false, "EndArray()");
 
-        m_nodes_stack_.pop_back(); // delete Array() marker
+        Array array = std::move(frame.array);
+        frames_.pop_back();
 
-        Array tmp_array; // generate new array
-        while (!tmp_nodes_stack.empty()) {
-            tmp_array.push_back(*tmp_nodes_stack.top());
-            tmp_nodes_stack.pop();
-        }
-
-        Builder::CreateNode(tmp_array, !IS_MARKER);
+        AddNode(Node{ std::move(array) });
 
         return *this;
     }
 
-    Node& Builder::Build() {
-        if (m_nodes_stack_.empty()) {
-            throw std::logic_error("Called Build() after constructor..."s);
-        }
-
-        if (m_nodes_stack_.back().is_marker || m_nodes_stack_.front().is_marker) {
+    Node Builder::Build() {
+        if (!frames_.empty()) {
             throw std::logic_error("Unconstructed node..."s);
         }
 
-        root_ = Node(*m_nodes_stack_.front().u_ptr);
-
-        return root_;
-    }
+        if (!root_) {
+            throw std::logic_error("Called Build() after constructor..."s);
+        }
 
-    void Builder::CheckIfOblectCompleated() {
-        constexpr int COMPLEATED_OBJECT_ELEMENTS_COUNT = 1;
-        bool obj_is_completed = (m_nodes_stack_.size() == COMPLEATED_OBJECT_ELEMENTS_COUNT
-                                 && !m_nodes_stack_.back().is_marker);
+        Node root = std::move(*root_);
+        root_.reset();
 
-        if (obj_is_completed) {
-            throw std::logic_error("Node is already compleated..."s);
-        }
+        return root;
     }
 
-} // namespace json
\ No newline at end of file
+} // namespace json
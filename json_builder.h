@@ -2,29 +2,19 @@
 
 #include "json.h"
 
-#include <functional>
-#include <memory>
-#include <stack>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace json {
     /*
-    The main idea is to save directives and values in std::vector, marking
-    directives by IS_MARKER and Values by !IS_MARKER
-    until EndDict() or EndArray() is reached.
-    If they are reached search previously saved marked directive in the array
-    and create Node from intermeadiate values and save them to the
-    previously marked directive place.
+    Containers under construction are kept in a stack of frames, values are moved
+    straight into the container on the top. An ended container is moved into its parent,
+    so a value is moved once on its way to the built node and no node is allocated on its own.
     */
 
-    inline bool IS_MARKER = true;
-
-    using u_ptr_Node = std::unique_ptr<json::Node>;
-
-    struct SNode {
-        u_ptr_Node u_ptr;
-        bool is_marker;
-    };
-
     class Builder;
     class StartX;
     class KeyContext;
@@ -36,7 +26,7 @@ namespace json {
         explicit DictItemContext(Builder& builder)
             : builder_(builder){};
 
-        KeyContext& Key(const std::string& key);
+        KeyContext& Key(std::string_view key);
         Builder& EndDict();
 
     private:
@@ -61,7 +51,7 @@ namespace json {
             : StartX(builder)
             , builder_(builder){};
 
-        DictItemContext& Value(const Node::Value& value);
+        DictItemContext& Value(Node value);
 
     private:
         Builder& builder_;
@@ -73,7 +63,7 @@ namespace json {
             : StartX(builder)
             , builder_(builder){};
 
-        StartArrayContext& Value(const Node::Value& value);
+        StartArrayContext& Value(Node value);
         Builder& EndArray();
 
     private:
@@ -84,10 +74,12 @@ namespace json {
     public:
         friend StartArrayContext;
 
-        Builder()
+        // Dicts and arrays of the built node are allocated from the resource
+        explicit Builder(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
             : DictItemContext(*this)
             , KeyContext(*this)
-            , StartArrayContext(*this) {
+            , StartArrayContext(*this)
+            , resource_(resource) {
         }
 
         DictItemContext& StartDict();
@@ -96,18 +88,35 @@ namespace json {
         Builder& EndDict();
         Builder& EndArray();
 
-        KeyContext& Key(const std::string& key);
-        Builder& Value(const Node::Value& value);
+        // Values are taken by value: an rvalue is moved, an lvalue is copied once.
+        // Keys are copied into the resource
+        KeyContext& Key(std::string_view key);
+        Builder& Value(Node value);
 
-        Node& Build();
+        // The node is moved out, the builder may be used again
+        Node Build();
 
     private:
-        void CreateNode(const Node::Value& value, bool is_marker);
-        void CheckIfOblectCompleated();
+        struct Frame {
+            explicit Frame(std::pmr::memory_resource* resource, bool is_dict)
+                : is_dict(is_dict)
+                , array(resource)
+                , dict(resource) {
+            }
+
+            bool is_dict;
+            Array array;
+            Dict dict;
+            std::optional<String> key; // of the next dict value
+        };
+
+        void AddNode(Node&& node);
+        Frame& GetTopFrame(bool is_dict, const char* method);
 
     private:
-        Node root_ = nullptr;
-        std::vector<SNode> m_nodes_stack_;
+        std::pmr::memory_resource* resource_;
+        std::optional<Node> root_;
+        std::vector<Frame> frames_;
     };
 
 } // namespace json
\ No newline at end of file
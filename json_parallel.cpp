@@ -0,0 +1,274 @@
+#include "json_parallel.h"
+#include "json_sax.h"
+
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <optional>
+#include <vector>
+
+namespace json {
+
+    using namespace std::literals;
+
+    namespace {
+
+        // smaller arrays are not worth a thread
+        constexpr size_t MIN_ITEMS_PER_THREAD = 256;
+
+        struct Span {
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
+        // An item of the root container
+        struct Member {
+            Span key; // of the root dict only, the end is set when ':' is found
+            Span value;
+            std::optional<Span> array; // brackets of an array found in the value
+            std::vector<Span> items;   // of the array
+        };
+
+        struct RootStructure {
+            char type = 0;
+            std::vector<Member> members;
+        };
+
+        bool IsBlank(std::string_view text) {
+            return std::all_of(text.begin(), text.end(), [](char c) {
+                return std::isspace(static_cast<unsigned char>(c));
+            });
+        }
+
+        // Position after the closing quote of a string which content starts at the position
+        std::optional<size_t> SkipString(std::string_view buffer, size_t pos) {
+            while (true) {
+                pos = buffer.find_first_of("\"\\"sv, pos);
+
+                if (pos == std::string_view::npos) {
+                    return std::nullopt;
+                }
+
+                if (buffer[pos] == '"') {
+                    return pos + 1;
+                }
+
+                pos += 2; // escaped char
+            }
+        }
+
+        // Structural scan: separators of the root container and of its array values,
+        // strings are skipped as a whole. Nothing for a scalar root or a broken structure
+        std::optional<RootStructure> ScanRoot(std::string_view buffer) {
+            size_t pos = 0;
+            while (pos < buffer.size() && std::isspace(static_cast<unsigned char>(buffer[pos]))) {
+                ++pos;
+            }
+
+            if (pos == buffer.size() || (buffer[pos] != '[' && buffer[pos] != '{')) {
+                return std::nullopt;
+            }
+
+            RootStructure root;
+            root.type = buffer[pos];
+
+            Member member;
+            size_t item_begin = 0;
+            int depth = 0;
+
+            auto is_in_array = [&member, &depth] {
+                return depth == 2 && member.array && member.array->end == 0;
+            };
+
+            for (; pos < buffer.size(); ++pos) {
+                const char current_char = buffer[pos];
+
+                switch (current_char) {
+                case '"':
+                    if (const auto string_end = SkipString(buffer, pos + 1)) {
+                        pos = *string_end - 1;
+                    } else {
+                        return std::nullopt;
+                    }
+                    break;
+                case '[': case '{':
+                    ++depth;
+
+                    if (depth == 1) {
+                        member.key.begin = member.value.begin = pos + 1;
+                    } else if (depth == 2 && current_char == '[') {
+                        if (member.array) {
+                            return std::nullopt;
+                        }
+
+                        member.array = Span{ pos, 0 };
+                        item_begin = pos + 1;
+                    }
+                    break;
+                case ']': case '}':
+                    if (current_char == ']' && is_in_array()) {
+                        member.items.push_back({ item_begin, pos });
+                        member.array->end = pos + 1;
+                    }
+
+                    if (--depth == 0) {
+                        member.value.end = pos;
+                        root.members.push_back(std::move(member));
+
+                        return root;
+                    }
+                    break;
+                case ',':
+                    if (depth == 1) {
+                        member.value.end = pos;
+                        root.members.push_back(std::move(member));
+
+                        member = Member{};
+                        member.key.begin = member.value.begin = pos + 1;
+                    } else if (is_in_array()) {
+                        member.items.push_back({ item_begin, pos });
+                        item_begin = pos + 1;
+                    }
+                    break;
+                case ':':
+                    if (depth == 1) {
+                        if (root.type != '{' || member.key.end != 0) {
+                            return std::nullopt;
+                        }
+
+                        member.key.end = pos;
+                        member.value.begin = pos + 1;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        std::string_view GetText(std::string_view buffer, Span span) {
+            return buffer.substr(span.begin, span.end - span.begin);
+        }
+
+        // The span should hold exactly one value
+        Node ParseSpan(std::string_view buffer, Span span, std::pmr::memory_resource* resource) {
+            const std::string_view text = GetText(buffer, span);
+
+            NodeHandler handler(resource);
+            const size_t parsed_size = ParseSax(text, handler);
+
+            if (!IsBlank(text.substr(parsed_size))) {
+                throw ParsingError("Unexpected data after a value"s);
+            }
+
+            return handler.Extract();
+        }
+
+        Node ParseItems(std::string_view buffer, const std::vector<Span>& items, size_t threads_count,
+                        std::pmr::memory_resource* resource) {
+            Array array(resource);
+
+            // "[ ]" has one blank item
+            if (items.size() == 1 && IsBlank(GetText(buffer, items.front()))) {
+                return Node{ std::move(array) };
+            }
+
+            array.resize(items.size());
+
+            auto parse_range = [&](size_t first, size_t last) {
+                for (size_t idx = first; idx < last; ++idx) {
+                    array[idx] = ParseSpan(buffer, items[idx], resource);
+                }
+            };
+
+            const size_t tasks_count = std::clamp<size_t>(items.size() / MIN_ITEMS_PER_THREAD, 1, std::max<size_t>(threads_count, 1));
+            const size_t range_size = (items.size() + tasks_count - 1) / tasks_count;
+
+            // the first range is parsed by the calling thread
+            std::vector<std::future<void>> tasks;
+            for (size_t first = range_size; first < items.size(); first += range_size) {
+                tasks.push_back(std::async(std::launch::async, parse_range, first, std::min(first + range_size, items.size())));
+            }
+
+            parse_range(0, std::min(range_size, items.size()));
+
+            for (auto& task : tasks) {
+                task.get();
+            }
+
+            return Node{ std::move(array) };
+        }
+
+        // Arrays are split only if nothing but the array is in the value
+        Node ParseMemberValue(std::string_view buffer, const Member& member, size_t threads_count,
+                              std::pmr::memory_resource* resource) {
+            if (member.array) {
+                const std::string_view before = buffer.substr(member.value.begin, member.array->begin - member.value.begin);
+                const std::string_view after = buffer.substr(member.array->end, member.value.end - member.array->end);
+
+                if (IsBlank(before) && IsBlank(after)) {
+                    return ParseItems(buffer, member.items, threads_count, resource);
+                }
+            }
+
+            return ParseSpan(buffer, member.value, resource);
+        }
+
+        Node ParseRoot(std::string_view buffer, const RootStructure& root, size_t threads_count,
+                       std::pmr::memory_resource* resource) {
+            if (root.type == '[') {
+                std::vector<Span> items;
+                items.reserve(root.members.size());
+
+                for (const Member& member : root.members) {
+                    items.push_back(member.value);
+                }
+
+                return ParseItems(buffer, items, threads_count, resource);
+            }
+
+            Dict dict(resource);
+
+            // "{ }" has one blank member without a key
+            const Member& first_member = root.members.front();
+            if (root.members.size() == 1 && first_member.key.end == 0 && IsBlank(GetText(buffer, first_member.value))) {
+                return Node{ std::move(dict) };
+            }
+
+            for (const Member& member : root.members) {
+                if (member.key.end == 0) {
+                    throw ParsingError("A key is expected"s);
+                }
+
+                const Node key = ParseSpan(buffer, member.key, resource);
+                if (!key.IsString()) {
+                    throw ParsingError("A key is expected"s);
+                }
+
+                if (dict.count(key.AsString()) > 0) {
+                    throw ParsingError("Duplicate key '"s + std::string(key.AsString()) + "' have been found"s);
+                }
+
+                dict.emplace(key.AsString(), ParseMemberValue(buffer, member, threads_count, resource));
+            }
+
+            return Node{ std::move(dict) };
+        }
+
+    } // namespace
+
+    Document LoadParallel(std::string_view buffer, size_t threads_count, std::pmr::memory_resource* resource) {
+        // a malformed buffer is parsed again sequentially for the same error
+        try {
+            if (const auto root = ScanRoot(buffer)) {
+                return Document{ ParseRoot(buffer, *root, threads_count, resource) };
+            }
+        } catch (const ParsingError&) {
+        }
+
+        return Load(buffer, resource);
+    }
+
+} // namespace json
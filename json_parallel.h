@@ -0,0 +1,20 @@
+#pragma once
+
+#include "json.h"
+
+#include <memory_resource>
+#include <string_view>
+
+namespace json {
+
+    /*
+    Parses the buffer like Load, but items of large arrays of the root (the root array itself
+    or arrays which are values of the root dict) are parsed by several threads.
+    A structural scan finds item boundaries first, then contiguous ranges of items are parsed
+    concurrently and put in their places. The resource should be thread-safe.
+    The result is the same document as the sequential one, malformed input gives the sequential error
+    */
+    Document LoadParallel(std::string_view buffer, size_t threads_count,
+                          std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+} // namespace json
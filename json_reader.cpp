@@ -1,9 +1,37 @@
 #include "json_reader.h"
+#include "json_sax.h"
+#include "thread_pool.h"
 
 using namespace std::literals;
 
-json::Document LoadJSON(std::istream& input) {
-    return json::Load(input);
+// convert velocity in km/h coefficient to calculate time in minutes
+double KmhToMetersPerMinute(double velocity) {
+    constexpr int meters_in_km = 1000;
+    constexpr int minutes_in_hour = 60;
+
+    return meters_in_km / double(minutes_in_hour) * velocity;
+}
+
+json::Document LoadJSON(std::istream& input, std::pmr::memory_resource* resource) {
+    return json::Load(input, resource);
+}
+
+json::Document LoadJSON(std::string_view buffer, std::pmr::memory_resource* resource) {
+    return json::Load(buffer, resource);
+}
+
+std::string ReadInput(std::istream& input) {
+    constexpr size_t chunk_size = 1 << 16;
+
+    std::string buffer;
+    while (input) {
+        const size_t size = buffer.size();
+        buffer.resize(size + chunk_size);
+        input.read(buffer.data() + size, chunk_size);
+        buffer.resize(size + static_cast<size_t>(input.gcount()));
+    }
+
+    return buffer;
 }
 
 json::Node Generate_Error_Message_Dict(int id, std::string_view text) {
@@ -13,14 +41,23 @@ json::Node Generate_Error_Message_Dict(int id, std::string_view text) {
                             .Key("request_id"s)
                             .Value(id)
                             .Key("error_message"s)
-                            .Value(std::string(text))
+                            .Value(json::String(text))
                             .EndDict()
                             .Build();
 
     return result;
 }
 
-json::Node GetTransportMapNode(const Stat& stat, const RequestHandler& rh) {
+void Write_Error_Message_Dict(json::Writer& writer, int id, std::string_view text) {
+    writer.StartDict()
+        .Key("error_message"sv)
+        .Value(text)
+        .Key("request_id"sv)
+        .Value(id)
+        .EndDict();
+}
+
+json::Node GetTransportMapNode(const Map_Request& stat, const RequestHandler& rh) {
     svg::Document doc_map = rh.RenderMap();
 
     std::stringstream ss;
@@ -35,20 +72,27 @@ json::Node Generate_TransportMap_Dict(int id, std::string_view raw_map_data) {
                             .Key("request_id"s)
                             .Value(id)
                             .Key("map"s)
-                            .Value(std::string(raw_map_data))
+                            .Value(json::String(raw_map_data))
                             .EndDict()
                             .Build();
 
     return result;
 }
 
-json::Node GetBusesListNode(const Stat& stat, const RequestHandler& rh) {
-    const BusesToStop& stop_info = rh.GetBusesByStop(stat.key_values.at("name"s));
+void Write_TransportMap_Dict(json::Writer& writer, int id, std::string_view raw_map_data) {
+    writer.StartDict()
+        .Key("map"sv)
+        .Value(raw_map_data)
+        .Key("request_id"sv)
+        .Value(id)
+        .EndDict();
+}
 
-    if (stop_info.notFound) {
+json::Node GetBusesListNode(const Stop_Request& stat, const RequestHandler& rh) {
+    if (stat.stop == nullptr) {
         return Generate_Error_Message_Dict(stat.id, "not found"sv);
     } else {
-        return Generate_Buses_List_Dict(stat.id, stop_info.buses);
+        return Generate_Buses_List_Dict(stat.id, rh.GetBusesByStop(stat.stop));
     }
 }
 
@@ -56,7 +100,7 @@ json::Node Generate_Buses_List_Dict(int id, const std::set<std::string_view>& bu
     json::Array j_buses;
 
     for (const auto& bus : buses_list) {
-        j_buses.push_back(std::string(bus));
+        j_buses.push_back(json::String(bus));
     }
 
     json::Node result = json::Builder()
@@ -71,8 +115,31 @@ json::Node Generate_Buses_List_Dict(int id, const std::set<std::string_view>& bu
     return result;
 }
 
-json::Node GetBusInfoNode(const Stat& stat, const RequestHandler& rh) {
-    const Bus_Route_Stat& bus_info = rh.GetBusStat(stat.key_values.at("name"s));
+void WriteBusesList(const Stop_Request& stat, const RequestHandler& rh, json::Writer& writer) {
+    if (stat.stop == nullptr) {
+        Write_Error_Message_Dict(writer, stat.id, "not found"sv);
+    } else {
+        Write_Buses_List_Dict(writer, stat.id, rh.GetBusesByStop(stat.stop));
+    }
+}
+
+void Write_Buses_List_Dict(json::Writer& writer, int id, const std::set<std::string_view>& buses_list) {
+    writer.StartDict()
+        .Key("buses"sv)
+        .StartArray();
+
+    for (const auto& bus : buses_list) {
+        writer.Value(bus);
+    }
+
+    writer.EndArray()
+        .Key("request_id"sv)
+        .Value(id)
+        .EndDict();
+}
+
+json::Node GetBusInfoNode(const Bus_Request& stat, const RequestHandler& rh) {
+    const Bus_Route_Stat& bus_info = rh.GetBusStat(stat.name);
 
     if (bus_info.stops_count == 0) {
         return Generate_Error_Message_Dict(stat.id, "not found"sv);
@@ -100,12 +167,106 @@ json::Node Generate_Route_Stat_Dict(int id, const Bus_Route_Stat& bus_route) {
     return result;
 }
 
-json::Node GetRouteNode(const Stat& stat, const RequestHandler& rh) {
+namespace {
+
+    // "total_time_only" applies to routes between stops by the base settings
+    bool IsRouteTimeOnly(const Route_Request& stat) {
+        return stat.total_time_only && !stat.HasOwnSettings() && !stat.departure_time;
+    }
+
+    // Stop of the field, nullptr if the name is unknown or there is no field
+    const Stop* FindStop(const json::Dict& dict, std::string_view key, const tc::TransportCatalogue& catalogue) {
+        const auto stop_it = dict.find(key);
+
+        return stop_it == dict.end() ? nullptr : catalogue.GetStopByName(stop_it->second.AsString());
+    }
+
+    std::vector<const Stop*> FindStops(const json::Dict& dict, std::string_view key,
+                                       const tc::TransportCatalogue& catalogue) {
+        std::vector<const Stop*> stops;
+
+        if (const auto list_it = dict.find(key); list_it != dict.end()) {
+            for (const auto& stop : list_it->second.AsArray()) {
+                stops.push_back(catalogue.GetStopByName(stop.AsString()));
+            }
+        }
+
+        return stops;
+    }
+
+    geo::Coordinates ParseCoordinates(const json::Dict& coordinates) {
+        return { coordinates.at("latitude").AsDouble(), coordinates.at("longitude").AsDouble() };
+    }
+
+} // namespace
+
+void WriteBusInfo(const Bus_Request& stat, const RequestHandler& rh, json::Writer& writer) {
+    const Bus_Route_Stat& bus_info = rh.GetBusStat(stat.name);
+
+    if (bus_info.stops_count == 0) {
+        Write_Error_Message_Dict(writer, stat.id, "not found"sv);
+    } else {
+        Write_Route_Stat_Dict(writer, stat.id, bus_info);
+    }
+}
+
+void Write_Route_Stat_Dict(json::Writer& writer, int id, const Bus_Route_Stat& bus_route) {
+    writer.StartDict()
+        .Key("curvature"sv)
+        .Value(bus_route.curvature)
+        .Key("request_id"sv)
+        .Value(id)
+        .Key("route_length"sv)
+        .Value(bus_route.length)
+        .Key("stop_count"sv)
+        .Value(bus_route.stops_count)
+        .Key("unique_stop_count"sv)
+        .Value(bus_route.unique_stops)
+        .EndDict();
+}
+
+std::optional<Route_Stat> GetRouteStat(const Route_Request& stat, const RequestHandler& rh) {
+
+    std::optional<Route_Stat> route_stat_opt;
+
+    if (stat.HasOwnSettings()) {
+        // settings of the request replace the base ones
+        Routing_settings routing_settings = rh.GetRoutingSettings();
+
+        if (stat.bus_wait_time) {
+            routing_settings.bus_wait_time = *stat.bus_wait_time;
+        }
+        if (stat.bus_velocity) {
+            routing_settings.bus_velocity = *stat.bus_velocity;
+        }
+
+        route_stat_opt = rh.GetRoute(stat.from, stat.to, routing_settings);
+    } else if (stat.departure_time) {
+        route_stat_opt = rh.GetRoute(stat.from, stat.to, *stat.departure_time);
+    } else {
+        route_stat_opt = rh.GetRoute(stat.from, stat.to);
+    }
+
+    return route_stat_opt;
+}
+
+json::Node GetRouteNode(const Route_Request& stat, const RequestHandler& rh) {
 
-    std::string from = stat.key_values.at("from");
-    std::string to = stat.key_values.at("to");
+    if (!stat.settings_error.empty()) {
+        return Generate_Error_Message_Dict(stat.id, stat.settings_error);
+    }
 
-    std::optional<Route_Stat> route_stat_opt = rh.GetRoute(from, to);
+    if (IsRouteTimeOnly(stat)) {
+        std::optional<double> route_time = rh.GetRouteTime(stat.from, stat.to);
+
+        if (route_time == std::nullopt) {
+            return Generate_Error_Message_Dict(stat.id, "not found"sv);
+        } else {
+            return Generate_Route_Time_Dict(stat.id, route_time.value());
+        }
+    }
+
+    const std::optional<Route_Stat> route_stat_opt = GetRouteStat(stat, rh);
 
     if (route_stat_opt == std::nullopt) {
         return Generate_Error_Message_Dict(stat.id, "not found"sv);
@@ -114,6 +275,206 @@ json::Node GetRouteNode(const Stat& stat, const RequestHandler& rh) {
     }
 }
 
+void WriteRoute(const Route_Request& stat, const RequestHandler& rh, json::Writer& writer) {
+
+    if (!stat.settings_error.empty()) {
+        Write_Error_Message_Dict(writer, stat.id, stat.settings_error);
+        return;
+    }
+
+    // a time answer is small and goes through a node
+    if (IsRouteTimeOnly(stat)) {
+        writer.Value(GetRouteNode(stat, rh));
+        return;
+    }
+
+    const std::optional<Route_Stat> route_stat_opt = GetRouteStat(stat, rh);
+
+    if (route_stat_opt == std::nullopt) {
+        Write_Error_Message_Dict(writer, stat.id, "not found"sv);
+    } else {
+        Write_Route_Dict(writer, stat.id, route_stat_opt.value());
+    }
+}
+
+void WriteRoute(const Coordinates_Route_Request& stat, const RequestHandler& rh, json::Writer& writer) {
+    if (stat.has_unsupported_options) {
+        Write_Error_Message_Dict(writer, stat.id,
+                                 "routing_settings and departure_time are not supported between coordinates"sv);
+        return;
+    }
+
+    const std::optional<Route_Stat> route_stat_opt = rh.GetRoute(stat.from, stat.to);
+
+    if (route_stat_opt == std::nullopt) {
+        Write_Error_Message_Dict(writer, stat.id, "not found"sv);
+    } else if (stat.total_time_only) {
+        writer.Value(Generate_Route_Time_Dict(stat.id, route_stat_opt->total_time));
+    } else {
+        Write_Route_Dict(writer, stat.id, route_stat_opt.value());
+    }
+}
+
+std::unordered_map<size_t, std::optional<Route_Stat>> GetRoutesBatch(const std::deque<Stat>& queries, size_t begin, size_t end,
+                                                                     const RequestHandler& rh) {
+    // query positions grouped by origin stop
+    std::unordered_map<const Stop*, std::vector<size_t>> origin_to_queries;
+
+    for (size_t i = begin; i < end; ++i) {
+        const auto* stat = std::get_if<Route_Request>(&queries[i]);
+
+        if (stat == nullptr) {
+            continue;
+        }
+
+        // routes by timetable or with own settings are answered by their own engines
+        if (stat->HasOwnSettings() || stat->departure_time || stat->total_time_only) {
+            continue;
+        }
+
+        origin_to_queries[stat->from].push_back(i);
+    }
+
+    const std::vector<std::pair<const Stop*, std::vector<size_t>>> groups(origin_to_queries.begin(),
+                                                                          origin_to_queries.end());
+    std::vector<std::vector<std::optional<Route_Stat>>> group_routes(groups.size());
+
+    // origins are searched independently, the router is safe for concurrent queries
+    ThreadPool::GetShared().ParallelFor(0, groups.size(), [&](size_t group_idx) {
+        const auto& [from, positions] = groups[group_idx];
+
+        std::vector<const Stop*> destinations;
+        destinations.reserve(positions.size());
+
+        for (size_t position : positions) {
+            destinations.push_back(std::get<Route_Request>(queries[position]).to);
+        }
+
+        group_routes[group_idx] = rh.GetRoutes(from, destinations);
+    });
+
+    std::unordered_map<size_t, std::optional<Route_Stat>> routes_by_position;
+
+    for (size_t group_idx = 0; group_idx < groups.size(); ++group_idx) {
+        const std::vector<size_t>& positions = groups[group_idx].second;
+
+        for (size_t i = 0; i < positions.size(); ++i) {
+            routes_by_position.emplace(positions[i], std::move(group_routes[group_idx][i]));
+        }
+    }
+
+    return routes_by_position;
+}
+
+json::Node GetTravelTimesNode(const Matrix_Request& stat, const RequestHandler& rh) {
+    return Generate_Travel_Times_Dict(stat.id, rh.GetTravelTimes(stat.sources, stat.targets));
+}
+
+json::Node Generate_Travel_Times_Dict(int id, const std::vector<std::vector<std::optional<double>>>& travel_times) {
+    json::Array j_rows;
+    j_rows.reserve(travel_times.size());
+
+    for (const auto& row : travel_times) {
+        json::Array j_row;
+        j_row.reserve(row.size());
+
+        // unreachable targets are marked by null
+        for (const auto& travel_time : row) {
+            if (travel_time) {
+                j_row.emplace_back(*travel_time);
+            } else {
+                j_row.emplace_back(nullptr);
+            }
+        }
+
+        j_rows.emplace_back(std::move(j_row));
+    }
+
+    json::Node result = json::Builder()
+                            .StartDict()
+                            .Key("request_id"s)
+                            .Value(id)
+                            .Key("total_times"s)
+                            .Value(std::move(j_rows))
+                            .EndDict()
+                            .Build();
+
+    return result;
+}
+
+json::Node GetReachableStopsNode(const Isochrone_Request& stat, const RequestHandler& rh) {
+    auto reachable_stops = rh.GetReachableStops(stat.from, stat.time_budget);
+
+    if (reachable_stops == std::nullopt) {
+        return Generate_Error_Message_Dict(stat.id, "not found"sv);
+    } else {
+        return Generate_Reachable_Stops_Dict(stat.id, reachable_stops.value());
+    }
+}
+
+json::Node Generate_Reachable_Stops_Dict(int id, const std::vector<std::pair<std::string_view, double>>& stops) {
+    json::Array j_stops;
+    j_stops.reserve(stops.size());
+
+    for (const auto& [stop_name, time] : stops) {
+        json::Dict dict;
+
+        dict.emplace("stop_name"sv, json::String(stop_name));
+        dict.emplace("time"sv, time);
+
+        j_stops.push_back(std::move(dict));
+    }
+
+    json::Node result = json::Builder()
+                            .StartDict()
+                            .Key("request_id"s)
+                            .Value(id)
+                            .Key("stops"s)
+                            .Value(std::move(j_stops))
+                            .EndDict()
+                            .Build();
+
+    return result;
+}
+
+json::Node Generate_Route_Time_Dict(int id, double total_time) {
+    json::Node result = json::Builder()
+                            .StartDict()
+                            .Key("request_id"s)
+                            .Value(id)
+                            .Key("total_time"s)
+                            .Value(total_time)
+                            .EndDict()
+                            .Build();
+
+    return result;
+}
+
+json::Node Generate_Update_Dict(int id, const Update_Stat& update_stat) {
+    json::Node result = json::Builder()
+                            .StartDict()
+                            .Key("request_id"s)
+                            .Value(id)
+                            .Key("changed_distances"s)
+                            .Value(update_stat.changed_distances)
+                            .Key("removed_buses"s)
+                            .Value(update_stat.removed_buses)
+                            .Key("added_buses"s)
+                            .Value(update_stat.added_buses)
+                            .Key("rebuilt_buses"s)
+                            .Value(update_stat.rebuilt_buses)
+                            .Key("removed_edges"s)
+                            .Value(static_cast<int>(update_stat.removed_edges))
+                            .Key("added_edges"s)
+                            .Value(static_cast<int>(update_stat.added_edges))
+                            .Key("repaired_sources"s)
+                            .Value(static_cast<int>(update_stat.repaired_sources))
+                            .EndDict()
+                            .Build();
+
+    return result;
+}
+
 json::Node Generate_Route_Dict(int id, const Route_Stat& route_stat) {
 
     json::Array j_array;
@@ -122,9 +483,9 @@ json::Node Generate_Route_Dict(int id, const Route_Stat& route_stat) {
         if (item.type == "Wait"s) {
             json::Dict dict;
 
-            dict.emplace("type"s, "Wait"s);
-            dict.emplace("stop_name"s, item.stop_name);
-            dict.emplace("time"s, route_stat.bus_wait_time);
+            dict.emplace("type"sv, "Wait");
+            dict.emplace("stop_name"sv, json::String(item.stop_name));
+            dict.emplace("time"sv, item.time);
 
             j_array.push_back(std::move(dict));
         }
@@ -132,10 +493,27 @@ json::Node Generate_Route_Dict(int id, const Route_Stat& route_stat) {
         if (item.type == "Bus"s) {
             json::Dict dict;
 
-            dict.emplace("type"s, "Bus"s);
-            dict.emplace("bus"s, item.bus_name);
-            dict.emplace("span_count"s, item.span_count);
-            dict.emplace("time"s, item.time);
+            dict.emplace("type"sv, "Bus");
+            dict.emplace("bus"sv, json::String(item.bus_name));
+            dict.emplace("span_count"sv, item.span_count);
+            dict.emplace("time"sv, item.time);
+
+            j_array.push_back(std::move(dict));
+        }
+
+        if (item.type == "Walk"s) {
+            json::Dict dict;
+
+            dict.emplace("type"sv, "Walk");
+            dict.emplace("time"sv, item.time);
+
+            // walking to the first stop has no origin stop and walking from the last stop has no destination
+            if (!item.stop_name.empty()) {
+                dict.emplace("from"sv, json::String(item.stop_name));
+            }
+            if (!item.to_stop_name.empty()) {
+                dict.emplace("to"sv, json::String(item.to_stop_name));
+            }
 
             j_array.push_back(std::move(dict));
         }
@@ -155,16 +533,77 @@ json::Node Generate_Route_Dict(int id, const Route_Stat& route_stat) {
     return result;
 }
 
-Parsed_Inputs_Queries ParseJson(const json::Document& document) {
+// Keys are written in the sorted order of json::Print
+void Write_Route_Dict(json::Writer& writer, int id, const Route_Stat& route_stat) {
+    writer.StartDict()
+        .Key("items"sv)
+        .StartArray();
+
+    for (const auto& item : route_stat.items) {
+        if (item.type == "Wait"sv) {
+            writer.StartDict()
+                .Key("stop_name"sv)
+                .Value(item.stop_name)
+                .Key("time"sv)
+                .Value(item.time)
+                .Key("type"sv)
+                .Value("Wait"sv)
+                .EndDict();
+        }
+
+        if (item.type == "Bus"sv) {
+            writer.StartDict()
+                .Key("bus"sv)
+                .Value(item.bus_name)
+                .Key("span_count"sv)
+                .Value(item.span_count)
+                .Key("time"sv)
+                .Value(item.time)
+                .Key("type"sv)
+                .Value("Bus"sv)
+                .EndDict();
+        }
+
+        if (item.type == "Walk"sv) {
+            writer.StartDict();
+
+            // walking to the first stop has no origin stop and walking from the last stop has no destination
+            if (!item.stop_name.empty()) {
+                writer.Key("from"sv).Value(item.stop_name);
+            }
+
+            writer.Key("time"sv).Value(item.time);
+
+            if (!item.to_stop_name.empty()) {
+                writer.Key("to"sv).Value(item.to_stop_name);
+            }
+
+            writer.Key("type"sv)
+                .Value("Walk"sv)
+                .EndDict();
+        }
+    }
+
+    writer.EndArray()
+        .Key("request_id"sv)
+        .Value(id)
+        .Key("total_time"sv)
+        .Value(route_stat.total_time)
+        .EndDict();
+}
+
+Parsed_Inputs_Queries ParseJson(const json::Document& document, tc::TransportCatalogue& catalogue) {
 
     Parsed_Inputs_Queries parsed;
+    std::deque<Stop> stops;
+    std::deque<Bus> buses;
 
-    const auto root_dict = document.GetRoot().AsDict();
+    const auto& root_dict = document.GetRoot().AsDict();
 
-    const auto& bases_stops_dict_it = root_dict.find("base_requests"s);
-    const auto& render_settings_dict_it = root_dict.find("render_settings"s);
-    const auto& stats_dict_it = root_dict.find("stat_requests"s);
-    const auto& routing_settings_dict_it = root_dict.find("routing_settings"s);
+    const auto& bases_stops_dict_it = root_dict.find("base_requests"sv);
+    const auto& render_settings_dict_it = root_dict.find("render_settings"sv);
+    const auto& stats_dict_it = root_dict.find("stat_requests"sv);
+    const auto& routing_settings_dict_it = root_dict.find("routing_settings"sv);
 
     // Read bus-stop array from json
     if (bases_stops_dict_it != root_dict.end()) {
@@ -173,7 +612,7 @@ Parsed_Inputs_Queries ParseJson(const json::Document& document) {
 
             const auto& entry_dict = it.AsDict();
 
-            const auto query_type_it = entry_dict.find("type"s);
+            const auto query_type_it = entry_dict.find("type"sv);
 
             // bus or stop
             if (query_type_it != entry_dict.end()) {
@@ -182,140 +621,311 @@ Parsed_Inputs_Queries ParseJson(const json::Document& document) {
 
                 if (type_name == "Bus"s) {
 
-                    Bus bus;
-                    bus.name = entry_dict.at("name"s).AsString();
-
-                    for (const auto& stop : entry_dict.at("stops"s).AsArray()) {
-                        bus.stops.push_back(stop.AsString());
-                    }
-
-                    bus.is_roundtrip = entry_dict.at("is_roundtrip"s).AsBool();
-
-                    parsed.buses.push_back(std::move(bus));
+                    buses.push_back(ParseBus(entry_dict));
                 }
 
                 if (type_name == "Stop"s) {
 
                     Stop stop;
-                    stop.name = entry_dict.at("name"s).AsString();
-                    stop.latitude = entry_dict.at("latitude"s).AsDouble();
-                    stop.longitude = entry_dict.at("longitude"s).AsDouble();
+                    stop.name = entry_dict.at("name").AsString();
+                    stop.latitude = entry_dict.at("latitude").AsDouble();
+                    stop.longitude = entry_dict.at("longitude").AsDouble();
 
-                    for (const auto& [stop_name, distance] : entry_dict.at("road_distances"s).AsDict()) {
+                    for (const auto& [stop_name, distance] : entry_dict.at("road_distances").AsDict()) {
                         stop.distances_to_stops.emplace_back(distance.AsInt(), stop_name);
                     }
 
-                    parsed.stops.push_back(std::move(stop));
+                    stops.push_back(std::move(stop));
                 }
             }
         }
     }
 
+    catalogue.FillTransportBase(stops, buses);
+
     if (routing_settings_dict_it != root_dict.end()) {
-        const auto routing_map = routing_settings_dict_it->second.AsDict();
+        parsed.routing_settings = ParseRoutingSettings(routing_settings_dict_it->second.AsDict());
+    }
+
+    if (render_settings_dict_it != root_dict.end()) {
+        parsed.render_settings = ParseRenderSettings(render_settings_dict_it->second.AsDict());
+    }
 
-        parsed.routing_settings.bus_wait_time = routing_map.at("bus_wait_time"s).AsInt();
+    // --- parse requests, their stops are resolved by the filled catalogue --- //
+    if (stats_dict_it != root_dict.end()) {
 
-        // convert velocity in km/h coefficient to calculate time in minutes
-        constexpr int meters_in_km = 1000;
-        constexpr int minutes_in_hour = 60;
-        parsed.routing_settings.bus_velocity =
-                meters_in_km / double(minutes_in_hour) * routing_map.at("bus_velocity"s).AsDouble();
+        for (const auto& it : stats_dict_it->second.AsArray()) {
+            if (auto request = ParseStatRequest(it.AsDict(), catalogue)) {
+                parsed.queries.push_back(std::move(*request));
+            }
+        }
     }
 
-    if (render_settings_dict_it != root_dict.end()) {
-        const auto render_map = render_settings_dict_it->second.AsDict();
+    return parsed;
+}
 
-        parsed.render_settings.width = render_map.at("width"s).AsDouble();
-        parsed.render_settings.height = render_map.at("height"s).AsDouble();
-        parsed.render_settings.padding = render_map.at("padding"s).AsDouble();
+Routing_settings ParseRoutingSettings(const json::Dict& routing_map) {
+    Routing_settings routing_settings;
 
-        parsed.render_settings.line_width = render_map.at("line_width"s).AsDouble();
-        parsed.render_settings.stop_radius = render_map.at("stop_radius"s).AsDouble();
+    routing_settings.bus_wait_time = routing_map.at("bus_wait_time").AsInt();
+    routing_settings.bus_velocity = KmhToMetersPerMinute(routing_map.at("bus_velocity").AsDouble());
 
-        parsed.render_settings.bus_label_font_size = render_map.at("bus_label_font_size"s).AsInt();
+    if (const auto mode_it = routing_map.find("router_mode"sv); mode_it != routing_map.end()) {
+        const std::string_view mode = mode_it->second.AsString();
 
-        auto bus_label_offset_arr = render_map.at("bus_label_offset"s).AsArray();
-        parsed.render_settings.bus_label_offset[0] = bus_label_offset_arr[0].AsDouble();
-        parsed.render_settings.bus_label_offset[1] = bus_label_offset_arr[1].AsDouble();
+        if (mode == "all_pairs"s) {
+            routing_settings.router_mode = RouterMode::ALL_PAIRS;
+        } else if (mode == "lazy"s) {
+            routing_settings.router_mode = RouterMode::LAZY;
+        } else if (mode == "mmap"s) {
+            routing_settings.router_mode = RouterMode::MAPPED;
+        } else {
+            throw std::logic_error("Unknown router mode "s + std::string(mode));
+        }
+    }
 
-        parsed.render_settings.stop_label_font_size = render_map.at("stop_label_font_size"s).AsInt();
+    if (const auto cache_it = routing_map.find("router_cache_size_mb"sv); cache_it != routing_map.end()) {
+        const int cache_size_mb = cache_it->second.AsInt();
 
-        auto stop_label_offset_arr = render_map.at("stop_label_offset"s).AsArray();
-        parsed.render_settings.stop_label_offset[0] = stop_label_offset_arr[0].AsDouble();
-        parsed.render_settings.stop_label_offset[1] = stop_label_offset_arr[1].AsDouble();
+        if (cache_size_mb <= 0) {
+            throw std::logic_error("Router cache size should be positive"s);
+        }
+        routing_settings.router_cache_size_mb = static_cast<size_t>(cache_size_mb);
+    }
 
-        parsed.render_settings.underlayer_color = getColorFromJsonNode(render_map.at("underlayer_color"s));
+    if (const auto file_it = routing_map.find("router_file"sv); file_it != routing_map.end()) {
+        routing_settings.router_file = file_it->second.AsString();
+    }
 
-        parsed.render_settings.underlayer_width = render_map.at("underlayer_width"s).AsDouble();
+    if (const auto walking_it = routing_map.find("walking_velocity"sv); walking_it != routing_map.end()) {
+        const double walking_velocity = walking_it->second.AsDouble();
 
-        auto color_palette_arr = render_map.at("color_palette"s).AsArray();
-        for (const auto& it : color_palette_arr) {
-            (parsed.render_settings.color_palette).push_back(getColorFromJsonNode(it));
+        if (walking_velocity <= 0) {
+            throw std::logic_error("Walking velocity should be positive"s);
         }
+        routing_settings.walking_velocity = KmhToMetersPerMinute(walking_velocity);
+    }
 
-        parsed.render_settings.height = render_map.at("height"s).AsDouble();
+    if (const auto radius_it = routing_map.find("stop_search_radius"sv); radius_it != routing_map.end()) {
+        routing_settings.stop_search_radius = radius_it->second.AsDouble();
     }
 
-    // --- parse requests --- //
-    if (stats_dict_it != root_dict.end()) {
+    if (const auto transfer_it = routing_map.find("walking_transfer_radius"sv); transfer_it != routing_map.end()) {
+        routing_settings.walking_transfer_radius = transfer_it->second.AsDouble();
+    }
 
-        for (const auto& it : stats_dict_it->second.AsArray()) {
+    if (const auto labels_it = routing_map.find("hub_labels_file"sv); labels_it != routing_map.end()) {
+        routing_settings.hub_labels_file = labels_it->second.AsString();
+    }
 
-            const auto& entry_dict = it.AsDict();
+    return routing_settings;
+}
 
-            Stat request;
-            request.id = entry_dict.at("id").AsInt();
-            std::string request_type = entry_dict.at("type").AsString();
+RenderSettings ParseRenderSettings(const json::Dict& render_map) {
+    RenderSettings render_settings;
 
-            if (request_type == "Route"s) {
-                request.type = RequestType::ROUTE;
+    render_settings.width = render_map.at("width").AsDouble();
+    render_settings.height = render_map.at("height").AsDouble();
+    render_settings.padding = render_map.at("padding").AsDouble();
 
-                const auto from_it = entry_dict.find("from"s);
-                const auto to_it = entry_dict.find("to"s);
+    render_settings.line_width = render_map.at("line_width").AsDouble();
+    render_settings.stop_radius = render_map.at("stop_radius").AsDouble();
 
-                if (from_it != entry_dict.end() && to_it != entry_dict.end()) {
-                    request.key_values["from"s] = from_it->second.AsString();
-                    request.key_values["to"s] = to_it->second.AsString();
-                }
+    render_settings.bus_label_font_size = render_map.at("bus_label_font_size").AsInt();
+
+    auto bus_label_offset_arr = render_map.at("bus_label_offset").AsArray();
+    render_settings.bus_label_offset[0] = bus_label_offset_arr[0].AsDouble();
+    render_settings.bus_label_offset[1] = bus_label_offset_arr[1].AsDouble();
+
+    render_settings.stop_label_font_size = render_map.at("stop_label_font_size").AsInt();
+
+    auto stop_label_offset_arr = render_map.at("stop_label_offset").AsArray();
+    render_settings.stop_label_offset[0] = stop_label_offset_arr[0].AsDouble();
+    render_settings.stop_label_offset[1] = stop_label_offset_arr[1].AsDouble();
+
+    render_settings.underlayer_color = getColorFromJsonNode(render_map.at("underlayer_color"));
+
+    render_settings.underlayer_width = render_map.at("underlayer_width").AsDouble();
+
+    auto color_palette_arr = render_map.at("color_palette").AsArray();
+    for (const auto& it : color_palette_arr) {
+        (render_settings.color_palette).push_back(getColorFromJsonNode(it));
+    }
 
-                parsed.queries.push_back(request);
+    render_settings.height = render_map.at("height").AsDouble();
+
+    return render_settings;
+}
+
+std::optional<Stat> ParseStatRequest(const json::Dict& entry_dict, const tc::TransportCatalogue& catalogue) {
+    const int id = entry_dict.at("id").AsInt();
+    const std::string_view request_type = entry_dict.at("type").AsString();
+
+    if (request_type == "Route"s) {
+        // route between arbitrary points instead of stops
+        const auto from_coords_it = entry_dict.find("from_coordinates"sv);
+        const auto to_coords_it = entry_dict.find("to_coordinates"sv);
+
+        if (from_coords_it != entry_dict.end() && to_coords_it != entry_dict.end()) {
+            Coordinates_Route_Request request{ id, ParseCoordinates(from_coords_it->second.AsDict()),
+                                               ParseCoordinates(to_coords_it->second.AsDict()) };
+
+            if (const auto time_only_it = entry_dict.find("total_time_only"sv); time_only_it != entry_dict.end()) {
+                request.total_time_only = time_only_it->second.AsBool();
             }
 
-            // "Stop" and "Bus" requests have similar structure
-            if (request_type == "Stop"s) {
-                request.type = RequestType::STOP;
-                const auto payload_it = entry_dict.find("name"s);
-                if (payload_it != entry_dict.end()) {
-                    request.key_values["name"s] = payload_it->second.AsString();
-                }
+            request.has_unsupported_options = entry_dict.count("routing_settings"sv) > 0
+                                              || entry_dict.count("departure_time"sv) > 0;
+
+            return request;
+        }
 
-                parsed.queries.push_back(request);
+        Route_Request request;
+        request.id = id;
+        request.from = FindStop(entry_dict, "from"s, catalogue);
+        request.to = FindStop(entry_dict, "to"s, catalogue);
+
+        if (const auto settings_it = entry_dict.find("routing_settings"sv); settings_it != entry_dict.end()) {
+            const auto& settings = settings_it->second.AsDict();
+
+            // an invalid value fails only this request, so it is answered with an error instead of thrown
+            if (const auto wait_it = settings.find("bus_wait_time"sv); wait_it != settings.end()) {
+                request.bus_wait_time = wait_it->second.AsInt();
+
+                if (*request.bus_wait_time < 0) {
+                    request.settings_error = "Bus wait time should not be negative"sv;
+                }
             }
+            if (const auto velocity_it = settings.find("bus_velocity"sv); velocity_it != settings.end()) {
+                const double bus_velocity = velocity_it->second.AsDouble();
+                request.bus_velocity = KmhToMetersPerMinute(bus_velocity);
 
-            if (request_type == "Bus"s) {
-                request.type = RequestType::BUS;
-                const auto payload_it = entry_dict.find("name"s);
-                if (payload_it != entry_dict.end()) {
-                    request.key_values["name"s] = payload_it->second.AsString();
+                if (bus_velocity <= 0) {
+                    request.settings_error = "Bus velocity should be positive"sv;
                 }
+            }
+        }
+
+        if (const auto departure_it = entry_dict.find("departure_time"sv); departure_it != entry_dict.end()) {
+            request.departure_time = departure_it->second.AsDouble();
+        }
+
+        if (const auto time_only_it = entry_dict.find("total_time_only"sv); time_only_it != entry_dict.end()) {
+            request.total_time_only = time_only_it->second.AsBool();
+        }
+
+        return request;
+    }
+
+    if (request_type == "Stop"s) {
+        return Stop_Request{ id, FindStop(entry_dict, "name"s, catalogue) };
+    }
+
+    if (request_type == "Bus"s) {
+        Bus_Request request{ id };
+
+        if (const auto name_it = entry_dict.find("name"sv); name_it != entry_dict.end()) {
+            request.name = name_it->second.AsString();
+        }
+
+        return request;
+    }
+
+    if (request_type == "Matrix"s) {
+        return Matrix_Request{ id, FindStops(entry_dict, "sources"s, catalogue), FindStops(entry_dict, "targets"s, catalogue) };
+    }
+
+    if (request_type == "Isochrone"s) {
+        Isochrone_Request request{ id };
+
+        const auto budget_it = entry_dict.find("time_budget"sv);
+
+        // without the budget the stop stays unknown and the answer is "not found"
+        if (budget_it != entry_dict.end()) {
+            request.from = FindStop(entry_dict, "from"s, catalogue);
+            request.time_budget = budget_it->second.AsDouble();
+        }
+
+        return request;
+    }
 
-                parsed.queries.push_back(request);
+    if (request_type == "Map"s) {
+        return Map_Request{ id };
+    }
+
+    if (request_type == "Update"s) {
+        Update_Request request{ id };
+        Transport_Update& update = request.update;
+
+        if (const auto distances_it = entry_dict.find("road_distances"sv); distances_it != entry_dict.end()) {
+            for (const auto& distance : distances_it->second.AsArray()) {
+                const auto& distance_dict = distance.AsDict();
+
+                update.road_distances.push_back({ std::string(distance_dict.at("from").AsString()),
+                                                  std::string(distance_dict.at("to").AsString()),
+                                                  distance_dict.at("distance").AsInt() });
             }
+        }
 
-            if (request_type == "Map"s) {
-                request.type = RequestType::MAP;
-                parsed.queries.push_back(std::move(request));
+        if (const auto add_it = entry_dict.find("add_buses"sv); add_it != entry_dict.end()) {
+            for (const auto& bus : add_it->second.AsArray()) {
+                update.add_buses.push_back(ParseBus(bus.AsDict()));
             }
         }
+
+        if (const auto remove_it = entry_dict.find("remove_buses"sv); remove_it != entry_dict.end()) {
+            for (const auto& bus_name : remove_it->second.AsArray()) {
+                update.remove_buses.emplace_back(bus_name.AsString());
+            }
+        }
+
+        return request;
     }
 
-    return parsed;
+    return std::nullopt;
+}
+
+Bus ParseBus(const json::Dict& bus_dict) {
+    Bus bus;
+    bus.name = bus_dict.at("name").AsString();
+
+    for (const auto& stop : bus_dict.at("stops").AsArray()) {
+        bus.stops.emplace_back(stop.AsString());
+    }
+
+    bus.is_roundtrip = bus_dict.at("is_roundtrip").AsBool();
+
+    if (const auto timetable_it = bus_dict.find("timetable"sv); timetable_it != bus_dict.end()) {
+        ParseBusTimetable(timetable_it->second.AsDict(), bus);
+    }
+
+    return bus;
+}
+
+// Either explicit departures or regular ones with an interval
+void ParseBusTimetable(const json::Dict& timetable, Bus& bus) {
+    if (const auto departures_it = timetable.find("departures"sv); departures_it != timetable.end()) {
+        for (const auto& departure : departures_it->second.AsArray()) {
+            bus.departures.push_back(departure.AsDouble());
+        }
+    } else {
+        const double first_departure = timetable.at("first_departure").AsDouble();
+        const double last_departure = timetable.at("last_departure").AsDouble();
+        const double interval = timetable.at("interval").AsDouble();
+
+        if (interval <= 0) {
+            throw std::logic_error("Timetable interval should be positive"s);
+        }
+
+        for (double departure = first_departure; departure <= last_departure; departure += interval) {
+            bus.departures.push_back(departure);
+        }
+    }
 }
 
 svg::Color getColorFromJsonNode(const json::Node& node) {
     if (node.IsString()) {
-        return node.AsString();
+        return std::string(node.AsString());
     }
 
     auto& arr = node.AsArray();
@@ -7,31 +7,71 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+
 struct Parsed_Inputs_Queries {
-    std::deque<Stop> stops;
-    std::deque<Bus> buses;
     std::deque<Stat> queries;
 
     RenderSettings render_settings;
     Routing_settings routing_settings;
 };
 
-json::Document LoadJSON(std::istream& input);
+json::Document LoadJSON(std::istream& input, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+json::Document LoadJSON(std::string_view buffer, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+// Reads the whole stream at once for the buffer parser
+std::string ReadInput(std::istream& input);
 
-Parsed_Inputs_Queries ParseJson(const json::Document& document);
+double KmhToMetersPerMinute(double velocity);
+
+// Fills the catalogue by "base_requests", stops of stat requests are resolved by it
+Parsed_Inputs_Queries ParseJson(const json::Document& document, tc::TransportCatalogue& catalogue);
+Routing_settings ParseRoutingSettings(const json::Dict& routing_map);
+RenderSettings ParseRenderSettings(const json::Dict& render_map);
+// Stop names are resolved by the filled catalogue, std::nullopt for unknown request types
+std::optional<Stat> ParseStatRequest(const json::Dict& entry_dict, const tc::TransportCatalogue& catalogue);
+Bus ParseBus(const json::Dict& bus_dict);
+void ParseBusTimetable(const json::Dict& timetable, Bus& bus);
 
 svg::Color getColorFromJsonNode(const json::Node& node);
 
 json::Node Generate_Error_Message_Dict(int id, std::string_view text);
 
+// Write_ functions put typed answers straight to the writer, the output is the same as of the nodes
+void Write_Error_Message_Dict(json::Writer& writer, int id, std::string_view text);
+
 json::Node Generate_TransportMap_Dict(int id, std::string_view raw_map_data);
-json::Node GetTransportMapNode(const Stat& stat, const RequestHandler& rh);
+json::Node GetTransportMapNode(const Map_Request& stat, const RequestHandler& rh);
+void Write_TransportMap_Dict(json::Writer& writer, int id, std::string_view raw_map_data);
 
 json::Node Generate_Buses_List_Dict(int id, const std::set<std::string_view>& buses_list);
-json::Node GetBusesListNode(const Stat& stat, const RequestHandler& rh);
+json::Node GetBusesListNode(const Stop_Request& stat, const RequestHandler& rh);
+void Write_Buses_List_Dict(json::Writer& writer, int id, const std::set<std::string_view>& buses_list);
+void WriteBusesList(const Stop_Request& stat, const RequestHandler& rh, json::Writer& writer);
 
 json::Node Generate_Route_Stat_Dict(int id, const Bus_Route_Stat& bus_info);
-json::Node GetBusInfoNode(const Stat& stat, const RequestHandler& rh);
+json::Node GetBusInfoNode(const Bus_Request& stat, const RequestHandler& rh);
+void Write_Route_Stat_Dict(json::Writer& writer, int id, const Bus_Route_Stat& bus_info);
+void WriteBusInfo(const Bus_Request& stat, const RequestHandler& rh, json::Writer& writer);
 
 json::Node Generate_Route_Dict(int id, const Route_Stat& route_stat);
-json::Node GetRouteNode(const Stat& stat, const RequestHandler& rh);
\ No newline at end of file
+json::Node Generate_Route_Time_Dict(int id, double total_time);
+json::Node Generate_Update_Dict(int id, const Update_Stat& update_stat);
+std::optional<Route_Stat> GetRouteStat(const Route_Request& stat, const RequestHandler& rh);
+json::Node GetRouteNode(const Route_Request& stat, const RequestHandler& rh);
+void Write_Route_Dict(json::Writer& writer, int id, const Route_Stat& route_stat);
+void WriteRoute(const Route_Request& stat, const RequestHandler& rh, json::Writer& writer);
+void WriteRoute(const Coordinates_Route_Request& stat, const RequestHandler& rh, json::Writer& writer);
+
+json::Node Generate_Travel_Times_Dict(int id, const std::vector<std::vector<std::optional<double>>>& travel_times);
+json::Node GetTravelTimesNode(const Matrix_Request& stat, const RequestHandler& rh);
+
+json::Node Generate_Reachable_Stops_Dict(int id, const std::vector<std::pair<std::string_view, double>>& stops);
+json::Node GetReachableStopsNode(const Isochrone_Request& stat, const RequestHandler& rh);
+
+// Finds routes of all "Route" queries of the range without updates with one search per distinct origin stop,
+// origins are searched in parallel by the shared pool. Routes are keyed by query position
+std::unordered_map<size_t, std::optional<Route_Stat>> GetRoutesBatch(const std::deque<Stat>& queries, size_t begin, size_t end,
+                                                                     const RequestHandler& rh);
\ No newline at end of file
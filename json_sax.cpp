@@ -0,0 +1,403 @@
+#include "json_sax.h"
+#include "char_set.h"
+
+#include <cctype>
+#include <charconv>
+
+namespace json {
+
+    using namespace std::literals;
+
+    namespace {
+
+        class SaxParser {
+        public:
+            SaxParser(SaxHandler& handler, std::string_view buffer)
+                : handler_(handler)
+                , pos_(buffer.data())
+                , end_(buffer.data() + buffer.size()) {
+            }
+
+            // Like the stream loader, reads one value and leaves the rest of the buffer
+            size_t Parse() {
+                const char* begin = pos_;
+                ParseValue();
+
+                return static_cast<size_t>(pos_ - begin);
+            }
+
+        private:
+            void SkipSpaces() {
+                while (pos_ != end_ && std::isspace(static_cast<unsigned char>(*pos_))) {
+                    ++pos_;
+                }
+            }
+
+            char NextChar() {
+                SkipSpaces();
+
+                if (pos_ == end_) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+
+                return *pos_++;
+            }
+
+            void ParseValue() {
+                const char current_char = NextChar();
+
+                switch (current_char) {
+                case '[':
+                    ParseArray();
+                    break;
+                case '{':
+                    ParseDict();
+                    break;
+                case '"':
+                    ParseString();
+                    break;
+                case 't': case 'f':
+                    --pos_;
+                    ParseBool();
+                    break;
+                case 'n':
+                    --pos_;
+                    ParseNull();
+                    break;
+                default:
+                    --pos_;
+                    ParseNumber();
+                    break;
+                }
+            }
+
+            void ParseArray() {
+                handler_.OnStartArray();
+
+                SkipSpaces();
+                if (pos_ != end_ && *pos_ == ']') {
+                    ++pos_;
+                } else {
+                    while (true) {
+                        ParseValue();
+
+                        const char current_char = NextChar();
+                        if (current_char == ']') {
+                            break;
+                        }
+                        if (current_char != ',') {
+                            throw ParsingError(R"(',' is expected but ')"s + current_char + "' has been found"s);
+                        }
+                    }
+                }
+
+                handler_.OnEndArray();
+            }
+
+            void ParseDict() {
+                handler_.OnStartDict();
+
+                SkipSpaces();
+                if (pos_ != end_ && *pos_ == '}') {
+                    ++pos_;
+                } else {
+                    while (true) {
+                        if (char current_char = NextChar(); current_char != '"') {
+                            throw ParsingError("A key is expected but '"s + current_char + "' has been found"s);
+                        }
+                        handler_.OnKey(ReadString());
+
+                        if (char current_char = NextChar(); current_char != ':') {
+                            throw ParsingError(": is expected but '"s + current_char + "' has been found"s);
+                        }
+                        ParseValue();
+
+                        const char current_char = NextChar();
+                        if (current_char == '}') {
+                            break;
+                        }
+                        if (current_char != ',') {
+                            throw ParsingError(R"(',' is expected but ')"s + current_char + "' has been found"s);
+                        }
+                    }
+                }
+
+                handler_.OnEndDict();
+            }
+
+            void ParseString() {
+                handler_.OnString(ReadString());
+            }
+
+            std::string_view ReadString() {
+                const char* begin = pos_;
+
+                // most strings have no escapes and stay views into the buffer
+                SkipPlainChars();
+
+                if (pos_ == end_) {
+                    throw ParsingError("String parsing error"s);
+                }
+
+                std::string_view str(begin, static_cast<size_t>(pos_ - begin));
+
+                if (*pos_ == '\\') {
+                    UnescapeString(str);
+                    str = unescaped_string_;
+                } else if (*pos_ != '"') {
+                    throw ParsingError("Unexpected end of line"s);
+                }
+
+                ++pos_; // closing quote
+
+                return str;
+            }
+
+            // Continues the string from the first escape, the prefix has no escapes
+            void UnescapeString(std::string_view prefix) {
+                std::string& str = unescaped_string_;
+                str.assign(prefix);
+
+                while (true) {
+                    const char* run_begin = pos_;
+                    SkipPlainChars();
+                    str.append(run_begin, static_cast<size_t>(pos_ - run_begin));
+
+                    if (pos_ == end_) {
+                        throw ParsingError("String parsing error"s);
+                    }
+
+                    const char current_char = *pos_;
+
+                    if (current_char == '"') {
+                        return;
+                    }
+
+                    if (current_char == '\\') {
+                        if (++pos_ == end_) {
+                            throw ParsingError("String parsing error"s);
+                        }
+
+                        switch (const char escaped_char = *pos_) {
+                        case 'n':
+                            str.push_back('\n');
+                            break;
+                        case 't':
+                            str.push_back('\t');
+                            break;
+                        case 'r':
+                            str.push_back('\r');
+                            break;
+                        case '"':
+                            str.push_back('"');
+                            break;
+                        case '\\':
+                            str.push_back('\\');
+                            break;
+                        default:
+                            throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                        }
+                    } else {
+                        throw ParsingError("Unexpected end of line"s);
+                    }
+
+                    ++pos_;
+                }
+            }
+
+            // Moves to the first quote, backslash or line break of a string
+            void SkipPlainChars() {
+                static const CharSet stop_chars("\"\\\n\r"sv);
+
+                pos_ += stop_chars.FindIn({ pos_, static_cast<size_t>(end_ - pos_) });
+            }
+
+            std::string_view ParseLiteral() {
+                const char* begin = pos_;
+
+                while (pos_ != end_ && std::isalpha(static_cast<unsigned char>(*pos_))) {
+                    ++pos_;
+                }
+
+                return { begin, static_cast<size_t>(pos_ - begin) };
+            }
+
+            void ParseBool() {
+                const std::string_view literal = ParseLiteral();
+
+                if (literal != "true"sv && literal != "false"sv) {
+                    throw ParsingError("Failed to parse '"s + std::string(literal) + "' as bool"s);
+                }
+
+                handler_.OnBool(literal == "true"sv);
+            }
+
+            void ParseNull() {
+                const std::string_view literal = ParseLiteral();
+
+                if (literal != "null"sv) {
+                    throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+                }
+
+                handler_.OnNull();
+            }
+
+            void SkipDigits() {
+                if (pos_ == end_ || !std::isdigit(static_cast<unsigned char>(*pos_))) {
+                    throw ParsingError("A digit is expected"s);
+                }
+
+                while (pos_ != end_ && std::isdigit(static_cast<unsigned char>(*pos_))) {
+                    ++pos_;
+                }
+            }
+
+            void ParseNumber() {
+                const char* begin = pos_;
+
+                if (pos_ != end_ && *pos_ == '-') {
+                    ++pos_;
+                }
+
+                if (pos_ != end_ && *pos_ == '0') {
+                    ++pos_;
+                } else {
+                    SkipDigits();
+                }
+
+                bool is_int = true;
+
+                if (pos_ != end_ && *pos_ == '.') {
+                    ++pos_;
+                    SkipDigits();
+                    is_int = false;
+                }
+
+                if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+                    ++pos_;
+                    if (pos_ != end_ && (*pos_ == '+' || *pos_ == '-')) {
+                        ++pos_;
+                    }
+
+                    SkipDigits();
+                    is_int = false;
+                }
+
+                // integers which don't fit int are passed as doubles
+                if (is_int) {
+                    int value = 0;
+                    if (auto [ptr, error] = std::from_chars(begin, pos_, value); error == std::errc{}) {
+                        handler_.OnInt(value);
+                        return;
+                    }
+                }
+
+                double value = 0.0;
+                if (auto [ptr, error] = std::from_chars(begin, pos_, value); error != std::errc{}) {
+                    throw ParsingError("Failed to convert "s + std::string(begin, pos_) + " to number"s);
+                }
+
+                handler_.OnDouble(value);
+            }
+
+        private:
+            SaxHandler& handler_;
+            const char* pos_;
+            const char* end_;
+            std::string unescaped_string_; // the last string with escapes
+        };
+
+    } // namespace
+
+    size_t ParseSax(std::string_view buffer, SaxHandler& handler) {
+        return SaxParser(handler, buffer).Parse();
+    }
+
+    NodeHandler::NodeHandler(std::pmr::memory_resource* resource)
+        : resource_(resource) {
+    }
+
+    void NodeHandler::OnNull() {
+        AddValue(Node{ nullptr });
+    }
+
+    void NodeHandler::OnBool(bool value) {
+        AddValue(Node{ value });
+    }
+
+    void NodeHandler::OnInt(int value) {
+        AddValue(Node{ value });
+    }
+
+    void NodeHandler::OnDouble(double value) {
+        AddValue(Node{ value });
+    }
+
+    void NodeHandler::OnString(std::string_view value) {
+        AddValue(Node{ String(value, resource_) });
+    }
+
+    void NodeHandler::OnStartArray() {
+        containers_.emplace_back(resource_);
+    }
+
+    void NodeHandler::OnEndArray() {
+        Array array = std::move(containers_.back().array);
+        containers_.pop_back();
+
+        AddValue(Node{ std::move(array) });
+    }
+
+    void NodeHandler::OnStartDict() {
+        containers_.emplace_back(resource_).is_dict = true;
+    }
+
+    void NodeHandler::OnKey(std::string_view key) {
+        Container& container = containers_.back();
+        if (container.dict.count(key) > 0) {
+            throw ParsingError("Duplicate key '"s + std::string(key) + "' have been found"s);
+        }
+
+        container.key.assign(key);
+    }
+
+    void NodeHandler::OnEndDict() {
+        Dict dict = std::move(containers_.back().dict);
+        containers_.pop_back();
+
+        AddValue(Node{ std::move(dict) });
+    }
+
+    bool NodeHandler::IsComplete() const {
+        return is_complete_;
+    }
+
+    Node NodeHandler::Extract() {
+        is_complete_ = false;
+        return std::move(root_);
+    }
+
+    void NodeHandler::AddValue(Node node) {
+        if (containers_.empty()) {
+            root_ = std::move(node);
+            is_complete_ = true;
+            return;
+        }
+
+        Container& container = containers_.back();
+
+        if (container.is_dict) {
+            container.dict.emplace(std::move(container.key), std::move(node));
+        } else {
+            container.array.push_back(std::move(node));
+        }
+    }
+
+    Document Load(std::string_view buffer, std::pmr::memory_resource* resource) {
+        NodeHandler handler(resource);
+        ParseSax(buffer, handler);
+
+        return Document{ handler.Extract() };
+    }
+
+} // namespace json
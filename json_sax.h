@@ -0,0 +1,86 @@
+#pragma once
+
+#include "json.h"
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+    /*
+    Receiver of parse events in document order. A dict item is a key event followed by the value events.
+    A string or a key view points into the parsed buffer if it has no escapes,
+    otherwise it is valid during the call only.
+    */
+    class SaxHandler {
+    public:
+        virtual ~SaxHandler() = default;
+
+        virtual void OnNull() = 0;
+        virtual void OnBool(bool value) = 0;
+        virtual void OnInt(int value) = 0;
+        virtual void OnDouble(double value) = 0;
+        virtual void OnString(std::string_view value) = 0;
+
+        virtual void OnStartArray() = 0;
+        virtual void OnEndArray() = 0;
+
+        virtual void OnStartDict() = 0;
+        virtual void OnKey(std::string_view key) = 0;
+        virtual void OnEndDict() = 0;
+    };
+
+    // Parses one value from the buffer start, the rest of the buffer is left. Returns the parsed size
+    size_t ParseSax(std::string_view buffer, SaxHandler& handler);
+
+    // Builds a node of the events of one value, containers and strings are allocated from the resource
+    class NodeHandler : public SaxHandler {
+    public:
+        explicit NodeHandler(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        void OnNull() override;
+        void OnBool(bool value) override;
+        void OnInt(int value) override;
+        void OnDouble(double value) override;
+        void OnString(std::string_view value) override;
+
+        void OnStartArray() override;
+        void OnEndArray() override;
+
+        void OnStartDict() override;
+        void OnKey(std::string_view key) override;
+        void OnEndDict() override;
+
+        // The value is complete when all started containers are ended
+        bool IsComplete() const;
+        Node Extract();
+
+    private:
+        struct Container {
+            explicit Container(std::pmr::memory_resource* resource)
+                : array(resource)
+                , dict(resource)
+                , key(resource) {
+            }
+
+            bool is_dict = false;
+            Array array;
+            Dict dict;
+            String key;
+        };
+
+        void AddValue(Node node);
+
+    private:
+        std::pmr::memory_resource* resource_;
+        std::vector<Container> containers_;
+        Node root_;
+        bool is_complete_ = false;
+    };
+
+    // Parses the buffer in place: nodes are built straight from the parse events
+    Document Load(std::string_view buffer, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+} // namespace json
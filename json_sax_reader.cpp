@@ -0,0 +1,343 @@
+#include "json_sax_reader.h"
+
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    class InputSaxHandler : public json::SaxHandler {
+    public:
+        InputSaxHandler(tc::TransportCatalogue& catalogue, StatConsumer* consumer)
+            : catalogue_(catalogue)
+            , consumer_(consumer) {
+        }
+
+        void OnNull() override {
+            if (is_capturing_) {
+                subtree_.OnNull();
+                return;
+            }
+
+            OnValue(json::Node{ nullptr });
+        }
+
+        void OnBool(bool value) override {
+            if (is_capturing_) {
+                subtree_.OnBool(value);
+                return;
+            }
+
+            OnValue(json::Node{ value });
+        }
+
+        void OnInt(int value) override {
+            if (is_capturing_) {
+                subtree_.OnInt(value);
+                return;
+            }
+
+            OnValue(json::Node{ value });
+        }
+
+        void OnDouble(double value) override {
+            if (is_capturing_) {
+                subtree_.OnDouble(value);
+                return;
+            }
+
+            OnValue(json::Node{ value });
+        }
+
+        void OnString(std::string_view value) override {
+            if (is_capturing_) {
+                subtree_.OnString(value);
+                return;
+            }
+
+            OnValue(json::Node{ json::String(value) });
+        }
+
+        void OnStartArray() override {
+            if (is_capturing_) {
+                subtree_.OnStartArray();
+                return;
+            }
+
+            const Context context = GetContext();
+
+            if (context == Context::ROOT && key_ == "base_requests"sv) {
+                contexts_.push_back(Context::BASE_ARRAY);
+            } else if (context == Context::ROOT && key_ == "stat_requests"sv && has_base_) {
+                contexts_.push_back(Context::STAT_ARRAY);
+                StartStreamingStats();
+            } else if (context == Context::BASE_ITEM && key_ == "stops"sv) {
+                contexts_.push_back(Context::BUS_STOPS);
+            } else {
+                is_capturing_ = true;
+                subtree_.OnStartArray();
+            }
+        }
+
+        void OnEndArray() override {
+            if (is_capturing_) {
+                subtree_.OnEndArray();
+                CheckCaptured();
+                return;
+            }
+
+            EndContext();
+        }
+
+        void OnStartDict() override {
+            if (is_capturing_) {
+                subtree_.OnStartDict();
+                return;
+            }
+
+            const Context context = GetContext();
+
+            if (context == Context::DOCUMENT) {
+                contexts_.push_back(Context::ROOT);
+            } else if (context == Context::BASE_ARRAY) {
+                contexts_.push_back(Context::BASE_ITEM);
+            } else if (context == Context::BASE_ITEM && key_ == "road_distances"sv) {
+                contexts_.push_back(Context::ROAD_DISTANCES);
+            } else {
+                is_capturing_ = true;
+                subtree_.OnStartDict();
+            }
+        }
+
+        void OnKey(std::string_view key) override {
+            if (is_capturing_) {
+                subtree_.OnKey(key);
+                return;
+            }
+
+            key_ = key;
+        }
+
+        void OnEndDict() override {
+            if (is_capturing_) {
+                subtree_.OnEndDict();
+                CheckCaptured();
+                return;
+            }
+
+            EndContext();
+        }
+
+        Parsed_Inputs_Queries& GetParsed() {
+            return parsed_;
+        }
+
+    private:
+        // Streamed containers, all other values are captured as nodes
+        enum class Context {
+            DOCUMENT,
+            ROOT,
+            BASE_ARRAY,
+            BASE_ITEM,
+            ROAD_DISTANCES,
+            BUS_STOPS,
+            STAT_ARRAY
+        };
+
+        Context GetContext() const {
+            return contexts_.empty() ? Context::DOCUMENT : contexts_.back();
+        }
+
+        void CheckCaptured() {
+            if (subtree_.IsComplete()) {
+                is_capturing_ = false;
+                OnValue(subtree_.Extract());
+            }
+        }
+
+        // A whole value of the current context
+        void OnValue(json::Node node) {
+            switch (GetContext()) {
+            case Context::DOCUMENT:
+                node.AsDict(); // the root is a dict or an error
+                break;
+            case Context::ROOT:
+                if (key_ == "routing_settings"sv) {
+                    parsed_.routing_settings = ParseRoutingSettings(node.AsDict());
+                    has_routing_settings_ = true;
+                } else if (key_ == "render_settings"sv) {
+                    parsed_.render_settings = ParseRenderSettings(node.AsDict());
+                    has_render_settings_ = true;
+                } else if (key_ == "base_requests"sv) {
+                    node.AsArray();
+                } else if (key_ == "stat_requests"sv) {
+                    // requests preceding the base wait for its stops
+                    node.AsArray();
+                    early_stats_ = std::move(node);
+                }
+                break;
+            case Context::BASE_ARRAY:
+                node.AsDict();
+                break;
+            case Context::BASE_ITEM:
+                if (!item_fields_.emplace(key_, std::move(node)).second) {
+                    throw json::ParsingError("Duplicate key '"s + key_ + "' have been found"s);
+                }
+                break;
+            case Context::ROAD_DISTANCES:
+                item_stop_.distances_to_stops.emplace_back(node.AsInt(), key_);
+                break;
+            case Context::BUS_STOPS:
+                item_bus_.stops.emplace_back(node.AsString());
+                break;
+            case Context::STAT_ARRAY:
+                AddStat(node.AsDict());
+                break;
+            }
+        }
+
+        void EndContext() {
+            const Context context = GetContext();
+            contexts_.pop_back();
+
+            switch (context) {
+            case Context::ROOT:
+                if (early_stats_) {
+                    for (const auto& stat : early_stats_->AsArray()) {
+                        AddStat(stat.AsDict());
+                    }
+                }
+                break;
+            case Context::BASE_ITEM:
+                AddBaseItem();
+                break;
+            case Context::BASE_ARRAY:
+                AddDeferredBase();
+                has_base_ = true;
+                break;
+            case Context::STAT_ARRAY:
+                is_streaming_stats_ = false;
+                break;
+            case Context::ROAD_DISTANCES:
+                has_road_distances_ = true;
+                break;
+            case Context::BUS_STOPS:
+                has_bus_stops_ = true;
+                break;
+            default:
+                break;
+            }
+        }
+
+        void AddBaseItem() {
+            // bus or stop
+            if (const auto type_it = item_fields_.find("type"sv); type_it != item_fields_.end()) {
+                const auto& type_name = type_it->second.AsString();
+
+                if (type_name == "Bus"s) {
+                    item_bus_.name = item_fields_.at("name").AsString();
+
+                    if (!has_bus_stops_) {
+                        throw std::out_of_range("Bus stops are not found"s);
+                    }
+
+                    item_bus_.is_roundtrip = item_fields_.at("is_roundtrip").AsBool();
+
+                    if (const auto timetable_it = item_fields_.find("timetable"sv); timetable_it != item_fields_.end()) {
+                        ParseBusTimetable(timetable_it->second.AsDict(), item_bus_);
+                    }
+
+                    buses_.push_back(std::move(item_bus_));
+                }
+
+                if (type_name == "Stop"s) {
+                    item_stop_.name = item_fields_.at("name").AsString();
+                    item_stop_.latitude = item_fields_.at("latitude").AsDouble();
+                    item_stop_.longitude = item_fields_.at("longitude").AsDouble();
+
+                    if (!has_road_distances_) {
+                        throw std::out_of_range("Stop road distances are not found"s);
+                    }
+
+                    catalogue_.AddStopToBase(item_stop_);
+                }
+            }
+
+            item_fields_.clear();
+            item_stop_ = Stop{};
+            item_bus_ = Bus{};
+            has_road_distances_ = false;
+            has_bus_stops_ = false;
+        }
+
+        void AddStat(const json::Dict& stat) {
+            if (auto request = ParseStatRequest(stat, catalogue_)) {
+                if (is_streaming_stats_) {
+                    consumer_->OnStat(*request);
+                } else {
+                    parsed_.queries.push_back(std::move(*request));
+                }
+            }
+        }
+
+        // Requests are answered while the input is read if nothing they depend on follows them
+        void StartStreamingStats() {
+            if (consumer_ == nullptr || !has_base_ || !has_routing_settings_ || !has_render_settings_) {
+                return;
+            }
+
+            consumer_->OnBaseReady(parsed_);
+            is_streaming_stats_ = true;
+        }
+
+        // distances and buses refer to stops which may follow them
+        void AddDeferredBase() {
+            for (const Stop& stop : catalogue_.GetAllStops()) {
+                catalogue_.AddStopDistancesToBase(stop);
+            }
+
+            for (const Bus& bus : buses_) {
+                catalogue_.AddRouteToBase(bus);
+            }
+
+            buses_.clear();
+        }
+
+    private:
+        tc::TransportCatalogue& catalogue_;
+        StatConsumer* consumer_;
+        Parsed_Inputs_Queries parsed_;
+
+        bool has_base_ = false;
+        bool has_routing_settings_ = false;
+        bool has_render_settings_ = false;
+        bool is_streaming_stats_ = false;
+        std::optional<json::Node> early_stats_;
+
+        std::vector<Context> contexts_;
+        std::string key_; // the last key of a streamed dict
+
+        bool is_capturing_ = false;
+        json::NodeHandler subtree_;
+
+        // the current "base_requests" item, its type may be the last key
+        json::Dict item_fields_;
+        Stop item_stop_;
+        Bus item_bus_;
+        bool has_road_distances_ = false;
+        bool has_bus_stops_ = false;
+
+        std::deque<Bus> buses_;
+    };
+
+} // namespace
+
+Parsed_Inputs_Queries ParseJsonSax(std::string_view buffer, tc::TransportCatalogue& catalogue,
+                                   StatConsumer* consumer) {
+    InputSaxHandler handler(catalogue, consumer);
+    json::ParseSax(buffer, handler);
+
+    return std::move(handler.GetParsed());
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "json_reader.h"
+#include "json_sax.h"
+#include "transport_catalogue.h"
+
+#include <string_view>
+
+// Receiver of stat requests which are read after the transport base and the settings
+class StatConsumer {
+public:
+    virtual ~StatConsumer() = default;
+
+    // The catalogue is filled and the settings are parsed, called once before the first request
+    virtual void OnBaseReady(const Parsed_Inputs_Queries& parsed) = 0;
+
+    // The request is dropped after the call
+    virtual void OnStat(const Stat& request) = 0;
+};
+
+// Streams the input into the catalogue without a document of "base_requests":
+// stops are added as they are read, distances and buses once all stops are known.
+// Settings and every stat request are small documents parsed by the usual functions,
+// stat requests preceding "base_requests" are kept as a document until the base is complete.
+// Stops and buses of the result are empty.
+// If "base_requests", "routing_settings" and "render_settings" precede "stat_requests",
+// stat requests are passed to the consumer one at a time as they are read instead of being collected
+Parsed_Inputs_Queries ParseJsonSax(std::string_view buffer, tc::TransportCatalogue& catalogue,
+                                   StatConsumer* consumer = nullptr);
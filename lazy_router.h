@@ -0,0 +1,107 @@
+#pragma once
+
+#include "dijkstra.h"
+#include "lru_cache.h"
+#include "router_base.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+namespace graph {
+
+    // Computes a shortest path tree for a source on its first use and keeps
+    // the most recently used trees while they fit the given memory budget
+    template <typename Weight>
+    class LazyRouter : public RouterBase<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+        using TreePtr = std::shared_ptr<const ShortestPathTree<Weight>>;
+
+    public:
+        using typename RouterBase<Weight>::RouteInfo;
+
+        LazyRouter(const Graph& graph, size_t max_memory_bytes)
+            : graph_(graph)
+            , cache_(GetRowsCapacity(graph, max_memory_bytes)) {
+        }
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override {
+            const TreePtr tree = GetTree(from);
+
+            return ExtractRoute(graph_, *tree, to);
+        }
+
+        // The tree of the source is taken from the cache or built and cached as for a single route
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override {
+            const TreePtr tree = GetTree(from);
+
+            std::vector<std::optional<RouteInfo>> routes;
+            routes.reserve(targets.size());
+
+            for (VertexId to : targets) {
+                routes.push_back(ExtractRoute(graph_, *tree, to));
+            }
+
+            return routes;
+        }
+
+        // Affected trees are dropped from the cache and will be rebuilt on demand
+        size_t Repair(const std::vector<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) override {
+            const std::unordered_set<EdgeId> removed_edges_set(removed_edges.begin(), removed_edges.end());
+
+            std::lock_guard guard(cache_mutex_);
+
+            return cache_.EraseIf([&](const TreePtr& tree) {
+                return IsTreeAffected(graph_, *tree, removed_edges_set, added_edges);
+            });
+        }
+
+        size_t GetCacheHits() const {
+            return cache_hits_;
+        }
+
+        size_t GetCacheMisses() const {
+            return cache_misses_;
+        }
+
+        size_t GetCacheCapacity() const {
+            return cache_.GetCapacity();
+        }
+
+    private:
+        static size_t GetRowsCapacity(const Graph& graph, size_t max_memory_bytes) {
+            const size_t row_bytes = graph.GetVertexCount() * (sizeof(Weight) + sizeof(EdgeId));
+
+            return row_bytes == 0 ? 1 : max_memory_bytes / row_bytes;
+        }
+
+        TreePtr GetTree(VertexId from) const {
+            {
+                std::lock_guard guard(cache_mutex_);
+
+                if (const TreePtr* cached = cache_.Get(from)) {
+                    ++cache_hits_;
+                    return *cached;
+                }
+            }
+
+            ++cache_misses_;
+
+            // the search runs unlocked, so queries for other sources are not blocked by it
+            TreePtr tree = std::make_shared<const ShortestPathTree<Weight>>(BuildShortestPathTree(graph_, from));
+
+            std::lock_guard guard(cache_mutex_);
+            return cache_.Put(from, std::move(tree));
+        }
+
+        const Graph& graph_;
+
+        mutable std::mutex cache_mutex_;
+        mutable LruCache<VertexId, TreePtr> cache_;
+        mutable std::atomic<size_t> cache_hits_ = 0;
+        mutable std::atomic<size_t> cache_misses_ = 0;
+    };
+
+} // namespace graph
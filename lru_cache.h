@@ -0,0 +1,92 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// Fixed capacity key-value cache evicting the least recently used entry.
+// Not thread-safe, owners are expected to guard it.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity)
+        : capacity_(capacity == 0 ? 1 : capacity) {
+    }
+
+    // Returns nullptr if the key is absent, otherwise marks the entry as recently used
+    Value* Get(const Key& key) {
+        auto it = index_.find(key);
+
+        if (it == index_.end()) {
+            return nullptr;
+        }
+
+        entries_.splice(entries_.begin(), entries_, it->second);
+
+        return &it->second->second;
+    }
+
+    Value& Put(const Key& key, Value value) {
+        if (auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+
+            return it->second->second;
+        }
+
+        if (entries_.size() == capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+
+        entries_.emplace_front(key, std::move(value));
+        index_[key] = entries_.begin();
+
+        return entries_.front().second;
+    }
+
+    void Erase(const Key& key) {
+        if (auto it = index_.find(key); it != index_.end()) {
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+    }
+
+    // Erases all entries whose values satisfy the predicate, returns their count
+    template <typename Predicate>
+    size_t EraseIf(Predicate predicate) {
+        size_t erased_count = 0;
+
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (predicate(it->second)) {
+                index_.erase(it->first);
+                it = entries_.erase(it);
+                ++erased_count;
+            } else {
+                ++it;
+            }
+        }
+
+        return erased_count;
+    }
+
+    void Clear() {
+        index_.clear();
+        entries_.clear();
+    }
+
+    size_t GetSize() const {
+        return entries_.size();
+    }
+
+    size_t GetCapacity() const {
+        return capacity_;
+    }
+
+private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    size_t capacity_;
+    Entries entries_;
+    std::unordered_map<Key, typename Entries::iterator, Hash> index_;
+};
@@ -1,60 +1,125 @@
-#include "graph.h"
+#include "json_parallel.h"
 #include "json_reader.h"
+#include "json_sax_reader.h"
 #include "map_renderer.h"
-#include "request_handler.h"
-#include "transport_router.h"
+#include "mapped_file.h"
+#include "program_options.h"
+#include "stat_processor.h"
+#include "stat_server.h"
+#include "thread_pool.h"
+
+#include <memory_resource>
+#include <optional>
+#include <system_error>
 
 using namespace std;
 
-int main() {
-    tc::TransportCatalogue transport_catalogue;
+// Builds the router once the base is read and answers each stat request as it is parsed
+class PipelinedAnswers : public StatConsumer {
+public:
+    PipelinedAnswers(tc::TransportCatalogue& catalogue, std::optional<StatProcessor>& processor, json::Writer& writer)
+        : catalogue_(catalogue)
+        , processor_(processor)
+        , writer_(writer) {
+    }
 
-    // Parse json input data
-    Parsed_Inputs_Queries parsed_inputs_queries = ParseJson(LoadJSON(cin));
+    void OnBaseReady(const Parsed_Inputs_Queries& parsed) override {
+        processor_.emplace(catalogue_, parsed.routing_settings, parsed.render_settings);
+    }
 
-    transport_catalogue.FillTransportBase(parsed_inputs_queries.stops, parsed_inputs_queries.buses);
+    void OnStat(const Stat& request) override {
+        processor_->Answer(request, writer_);
+    }
 
-    // Init Graph
-    graph::DirectedWeightedGraph<double> routes_graph(transport_catalogue.GetAllStopsCount()); // one vertex por one Stop
+private:
+    tc::TransportCatalogue& catalogue_;
+    std::optional<StatProcessor>& processor_;
+    json::Writer& writer_;
+};
 
-    // Prepare the graph to be filled with transport base 
-    Transport_router transport_router(routes_graph, transport_catalogue, parsed_inputs_queries.routing_settings);
-    transport_router.CreateGraph();
+// The file is mapped, stdin is read at once, both are parsed in place and released after parsing
+Parsed_Inputs_Queries LoadInputs(const Program_options& options, tc::TransportCatalogue& catalogue,
+                                 StatConsumer* consumer) {
+    std::optional<MappedFile> input_file;
+    std::string input;
+    std::string_view buffer;
 
-    // Handle the graph
-    graph::Router<double> router(routes_graph);
+    if (!options.input_file.empty()) {
+        input_file = MappedFile::Open(options.input_file);
+        buffer = std::string_view(input_file->GetData(), input_file->GetSize());
+    } else {
+        input = ReadInput(cin);
+        buffer = input;
+    }
 
-    // Set SVG renderer
-    MapRenderer map_renderer(parsed_inputs_queries.render_settings);
+    if (options.sax_input) {
+        return ParseJsonSax(buffer, catalogue, consumer);
+    }
 
-    // Handle requests
-    RequestHandler requestHandler(transport_catalogue, map_renderer, router, transport_router);
+    Parsed_Inputs_Queries parsed;
 
-    // --- process queries and generate output json array node --- //
-    json::Array json_answer_array;
+    // the document is allocated in one arena and released at once after parsing,
+    // threads share a synchronized one
+    if (options.parse_threads > 1) {
+        std::pmr::synchronized_pool_resource arena;
+        parsed = ParseJson(json::LoadParallel(buffer, options.parse_threads, &arena), catalogue);
+    } else {
+        std::pmr::monotonic_buffer_resource arena;
+        parsed = ParseJson(LoadJSON(buffer, &arena), catalogue);
+    }
 
-    for (const auto& request : parsed_inputs_queries.queries) {
+    return parsed;
+}
 
-        switch (request.type)
-        {
-        case RequestType::ROUTE:
-            json_answer_array.push_back(GetRouteNode(request, requestHandler));
-            break;
-        case RequestType::BUS:
-            json_answer_array.push_back(GetBusInfoNode(request, requestHandler));
-            break;        
-        case RequestType::STOP:
-            json_answer_array.push_back(GetBusesListNode(request, requestHandler));
-            break;
-        case RequestType::MAP:
-            json_answer_array.push_back(GetTransportMapNode(request, requestHandler));
-            break;                    
-        default:
-            break;
-        }
+int main(int argc, char* argv[]) {
+    Program_options program_options;
+
+    try {
+        program_options = ParseProgramOptions(argc, argv);
+    } catch (const std::invalid_argument& error) {
+        cerr << error.what() << endl;
+        return 1;
+    }
+
+    if (program_options.threads > 0) {
+        ThreadPool::SetSharedThreadsCount(program_options.threads);
     }
 
-    json::Print(json::Document{ json_answer_array }, std::cout);
+    tc::TransportCatalogue transport_catalogue;
+
+    // answers are printed as soon as they are ready
+    json::Writer answers_writer(std::cout, { program_options.compact_output, program_options.shortest_doubles });
+    answers_writer.StartArray();
+
+    // Parse json input data and fill the transport base, pipelined requests are answered while parsing
+    std::optional<StatProcessor> stat_processor;
+    PipelinedAnswers pipelined_answers(transport_catalogue, stat_processor, answers_writer);
+
+    Parsed_Inputs_Queries parsed_inputs_queries = LoadInputs(program_options, transport_catalogue,
+                                                             program_options.pipeline ? &pipelined_answers : nullptr);
+
+    // Build the router and answer the collected requests
+    if (!stat_processor) {
+        stat_processor.emplace(transport_catalogue, parsed_inputs_queries.routing_settings,
+                               parsed_inputs_queries.render_settings);
+    }
+
+    stat_processor->AnswerBatch(parsed_inputs_queries.queries, answers_writer, program_options.answer_threads);
+
+    answers_writer.EndArray().Flush();
+    stat_processor->PrintRouterStats(cerr);
+
+    // The base stays loaded to serve requests of clients until the process is stopped
+    if (!program_options.serve_address.empty()) {
+        StatServer server(transport_catalogue, *stat_processor, answers_writer.GetOptions());
+
+        try {
+            server.Serve(program_options.serve_address);
+        } catch (const std::system_error& error) {
+            cerr << error.what() << endl;
+            return 1;
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,157 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+    // Closes the descriptor when the mapping is done, the mapping keeps the file alive
+    class FileDescriptor {
+    public:
+        explicit FileDescriptor(int fd)
+            : fd_(fd) {
+        }
+
+        FileDescriptor(const FileDescriptor&) = delete;
+        FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+        ~FileDescriptor() {
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+        }
+
+        int Get() const {
+            return fd_;
+        }
+
+    private:
+        int fd_;
+    };
+
+    [[noreturn]] void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+} // namespace
+
+MappedFile MappedFile::Create(const std::string& path, size_t size) {
+    int fd = -1;
+
+    if (path.empty()) {
+        std::string temp_path = "/tmp/transport_router_XXXXXX"s;
+        std::vector<char> temp_path_buffer(temp_path.begin(), temp_path.end());
+        temp_path_buffer.push_back('\0');
+
+        fd = mkstemp(temp_path_buffer.data());
+        if (fd >= 0) {
+            unlink(temp_path_buffer.data());
+        }
+    } else {
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+
+    const FileDescriptor file(fd);
+
+    if (file.Get() < 0) {
+        ThrowSystemError("Can't create file "s + path);
+    }
+
+    if (size == 0) {
+        return MappedFile(nullptr, 0);
+    }
+
+    if (ftruncate(file.Get(), static_cast<off_t>(size)) != 0) {
+        ThrowSystemError("Can't resize file "s + path);
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file.Get(), 0);
+    if (data == MAP_FAILED) {
+        ThrowSystemError("Can't map file "s + path);
+    }
+
+    return MappedFile(data, size);
+}
+
+MappedFile MappedFile::Open(const std::string& path) {
+    const FileDescriptor file(open(path.c_str(), O_RDONLY));
+
+    if (file.Get() < 0) {
+        ThrowSystemError("Can't open file "s + path);
+    }
+
+    struct stat file_stat{};
+    if (fstat(file.Get(), &file_stat) != 0) {
+        ThrowSystemError("Can't get size of file "s + path);
+    }
+
+    const auto size = static_cast<size_t>(file_stat.st_size);
+
+    if (size == 0) {
+        return MappedFile(nullptr, 0);
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.Get(), 0);
+    if (data == MAP_FAILED) {
+        ThrowSystemError("Can't map file "s + path);
+    }
+
+    return MappedFile(data, size);
+}
+
+MappedFile::MappedFile(void* data, size_t size)
+    : data_(data)
+    , size_(size) {
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    Unmap();
+}
+
+void MappedFile::Unmap() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+
+    data_ = nullptr;
+    size_ = 0;
+}
+
+char* MappedFile::GetData() {
+    return static_cast<char*>(data_);
+}
+
+const char* MappedFile::GetData() const {
+    return static_cast<const char*>(data_);
+}
+
+size_t MappedFile::GetSize() const {
+    return size_;
+}
+
+size_t MappedFile::GetPageSize() {
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Memory-mapped file. Pages are loaded and evicted by the OS page cache
+class MappedFile {
+public:
+    // Creates the file of the size mapped for reading and writing.
+    // An empty path gives a temporary file which is removed from the disk at once
+    static MappedFile Create(const std::string& path, size_t size);
+
+    // Maps an existing file for reading only
+    static MappedFile Open(const std::string& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    char* GetData();
+    const char* GetData() const;
+    size_t GetSize() const;
+
+    static size_t GetPageSize();
+
+private:
+    MappedFile(void* data, size_t size);
+
+    void Unmap();
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "dijkstra.h"
+#include "mapped_file.h"
+#include "router_base.h"
+#include "thread_pool.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace graph {
+
+    // Keeps shortest path trees of all sources in a memory-mapped file, so the table may exceed RAM.
+    // Every source has its own page-aligned tile: weights row followed by previous edges row,
+    // a route is read from one tile sequentially and straight from the mapping
+    template <typename Weight>
+    class MappedRouter : public RouterBase<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using typename RouterBase<Weight>::RouteInfo;
+
+        // An empty file path gives a temporary file
+        MappedRouter(const Graph& graph, const std::string& file_path)
+            : graph_(graph)
+            , prev_edges_offset_(GetPrevEdgesOffset(graph.GetVertexCount()))
+            , tile_size_(GetTileSize(graph.GetVertexCount()))
+            , file_(MappedFile::Create(file_path, tile_size_ * graph.GetVertexCount())) {
+
+            // tiles don't overlap, so the threads write them independently
+            ThreadPool::GetShared().ParallelFor(0, graph_.GetVertexCount(), [this](VertexId source) {
+                WriteTile(source);
+            });
+        }
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override {
+            if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+                return std::nullopt;
+            }
+
+            return ExtractRoute(graph_, GetWeights(from), GetPrevEdges(from), to);
+        }
+
+        size_t Repair(const std::vector<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) override {
+            const std::unordered_set<EdgeId> removed_edges_set(removed_edges.begin(), removed_edges.end());
+
+            std::vector<VertexId> affected_sources;
+            for (VertexId source = 0; source < graph_.GetVertexCount(); ++source) {
+                if (IsTreeAffected(graph_, GetWeights(source), GetPrevEdges(source), removed_edges_set, added_edges)) {
+                    affected_sources.push_back(source);
+                }
+            }
+
+            ThreadPool::GetShared().ParallelFor(0, affected_sources.size(), [this, &affected_sources](size_t idx) {
+                WriteTile(affected_sources[idx]);
+            });
+
+            return affected_sources.size();
+        }
+
+        size_t GetFileSize() const {
+            return file_.GetSize();
+        }
+
+    private:
+        static size_t AlignUp(size_t size, size_t alignment) {
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        static size_t GetPrevEdgesOffset(size_t vertex_count) {
+            return AlignUp(vertex_count * sizeof(Weight), alignof(EdgeId));
+        }
+
+        static size_t GetTileSize(size_t vertex_count) {
+            return AlignUp(GetPrevEdgesOffset(vertex_count) + vertex_count * sizeof(EdgeId), MappedFile::GetPageSize());
+        }
+
+        void WriteTile(VertexId source) {
+            const ShortestPathTree<Weight> tree = BuildShortestPathTree(graph_, source);
+            char* tile = file_.GetData() + source * tile_size_;
+
+            std::memcpy(tile, tree.weights.data(), tree.weights.size() * sizeof(Weight));
+            std::memcpy(tile + prev_edges_offset_, tree.prev_edges.data(), tree.prev_edges.size() * sizeof(EdgeId));
+        }
+
+        const Weight* GetWeights(VertexId source) const {
+            return reinterpret_cast<const Weight*>(file_.GetData() + source * tile_size_);
+        }
+
+        const EdgeId* GetPrevEdges(VertexId source) const {
+            return reinterpret_cast<const EdgeId*>(file_.GetData() + source * tile_size_ + prev_edges_offset_);
+        }
+
+        const Graph& graph_;
+        size_t prev_edges_offset_;
+        size_t tile_size_;
+        MappedFile file_;
+    };
+
+} // namespace graph
@@ -0,0 +1,325 @@
+#include "overlay_router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+using namespace std;
+
+namespace graph {
+
+    namespace {
+        constexpr double INF_WEIGHT = std::numeric_limits<double>::infinity();
+    }
+
+    OverlayRouter::SearchSpace::SearchSpace(size_t vertex_count)
+        : weights(vertex_count, INF_WEIGHT)
+        , arcs(vertex_count) {
+    }
+
+    void OverlayRouter::SearchSpace::Reset() {
+        for (VertexId vertex : touched) {
+            weights[vertex] = INF_WEIGHT;
+            arcs[vertex] = Arc{};
+        }
+
+        touched.clear();
+    }
+
+    OverlayRouter::OverlayRouter(const Graph& graph, const std::vector<geo::Coordinates>& vertex_coordinates)
+        : graph_(graph) {
+
+        if (vertex_coordinates.size() != graph_.GetVertexCount()) {
+            throw std::invalid_argument("Coordinates are required for every vertex"s);
+        }
+
+        for (size_t cell_size = FINEST_CELL_SIZE; cell_size < graph_.GetVertexCount(); cell_size *= CELL_SIZE_FACTOR) {
+            level_cell_sizes_.push_back(cell_size);
+        }
+
+        Partition(vertex_coordinates);
+        FindBoundaries();
+    }
+
+    size_t OverlayRouter::GetLevelsCount() const {
+        return level_cell_sizes_.size();
+    }
+
+    void OverlayRouter::Partition(const std::vector<geo::Coordinates>& vertex_coordinates) {
+        const size_t levels_count = level_cell_sizes_.size();
+
+        cells_.assign(levels_count, std::vector<uint32_t>(graph_.GetVertexCount(), 0));
+        std::vector<uint32_t> cells_counts(levels_count, 0);
+
+        std::vector<VertexId> vertices(graph_.GetVertexCount());
+        for (VertexId vertex = 0; vertex < vertices.size(); ++vertex) {
+            vertices[vertex] = vertex;
+        }
+
+        // Splits a range by the median of its wider coordinate. A range is assigned to a cell of a level
+        // when it first fits the level size, so cells of finer levels are nested into coarser ones
+        std::function<void(size_t, size_t, size_t)> bisect = [&](size_t begin, size_t end, size_t levels_left) {
+            const size_t size = end - begin;
+
+            while (levels_left > 0 && size <= level_cell_sizes_[levels_left - 1]) {
+                const size_t level_idx = levels_left - 1;
+
+                for (size_t i = begin; i < end; ++i) {
+                    cells_[level_idx][vertices[i]] = cells_counts[level_idx];
+                }
+
+                ++cells_counts[level_idx];
+                --levels_left;
+            }
+
+            if (levels_left == 0) {
+                return;
+            }
+
+            const auto [lat_min, lat_max] = std::minmax_element(
+                    vertices.begin() + begin, vertices.begin() + end,
+                    [&](VertexId lhs, VertexId rhs) { return vertex_coordinates[lhs].lat < vertex_coordinates[rhs].lat; });
+            const auto [lng_min, lng_max] = std::minmax_element(
+                    vertices.begin() + begin, vertices.begin() + end,
+                    [&](VertexId lhs, VertexId rhs) { return vertex_coordinates[lhs].lng < vertex_coordinates[rhs].lng; });
+
+            const bool by_lat = vertex_coordinates[*lat_max].lat - vertex_coordinates[*lat_min].lat
+                                >= vertex_coordinates[*lng_max].lng - vertex_coordinates[*lng_min].lng;
+
+            const size_t middle = begin + size / 2;
+            std::nth_element(vertices.begin() + begin, vertices.begin() + middle, vertices.begin() + end,
+                             [&](VertexId lhs, VertexId rhs) {
+                                 return by_lat ? vertex_coordinates[lhs].lat < vertex_coordinates[rhs].lat
+                                               : vertex_coordinates[lhs].lng < vertex_coordinates[rhs].lng;
+                             });
+
+            bisect(begin, middle, levels_left);
+            bisect(middle, end, levels_left);
+        };
+
+        bisect(0, vertices.size(), levels_count);
+
+        boundaries_.resize(levels_count);
+        for (size_t level_idx = 0; level_idx < levels_count; ++level_idx) {
+            boundaries_[level_idx].resize(cells_counts[level_idx]);
+        }
+    }
+
+    void OverlayRouter::FindBoundaries() {
+        const size_t levels_count = level_cell_sizes_.size();
+
+        boundary_positions_.assign(levels_count, std::vector<uint32_t>(graph_.GetVertexCount(), NO_POS));
+
+        const auto add_boundary = [this](size_t level_idx, VertexId vertex) {
+            if (boundary_positions_[level_idx][vertex] == NO_POS) {
+                auto& boundary = boundaries_[level_idx][cells_[level_idx][vertex]];
+
+                boundary_positions_[level_idx][vertex] = static_cast<uint32_t>(boundary.size());
+                boundary.push_back(vertex);
+            }
+        };
+
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            if (graph_.IsEdgeRemoved(edge_id)) {
+                continue;
+            }
+
+            const auto& edge = graph_.GetEdge(edge_id);
+
+            for (size_t level_idx = 0; level_idx < levels_count; ++level_idx) {
+                if (cells_[level_idx][edge.from] != cells_[level_idx][edge.to]) {
+                    add_boundary(level_idx, edge.from);
+                    add_boundary(level_idx, edge.to);
+                }
+            }
+        }
+    }
+
+    uint32_t OverlayRouter::GetCell(size_t level, VertexId vertex) const {
+        return cells_[level - 1][vertex];
+    }
+
+    size_t OverlayRouter::GetQueryLevel(VertexId vertex, VertexId from, VertexId to) const {
+        // the coarsest level where the vertex cell contains neither endpoint
+        for (size_t level = level_cell_sizes_.size(); level > 0; --level) {
+            const uint32_t cell = GetCell(level, vertex);
+
+            if (cell != GetCell(level, from) && cell != GetCell(level, to)) {
+                return level;
+            }
+        }
+
+        return 0;
+    }
+
+    template <typename Callback>
+    void OverlayRouter::ForEachArc(const Metric& metric, VertexId vertex, size_t level, Callback callback) const {
+        if (level > 0) {
+            const size_t level_idx = level - 1;
+            const uint32_t cell = cells_[level_idx][vertex];
+            const auto& boundary = boundaries_[level_idx][cell];
+            const auto& clique = metric.cliques[level_idx][cell];
+
+            const size_t row = boundary_positions_[level_idx][vertex] * boundary.size();
+
+            for (size_t pos = 0; pos < boundary.size(); ++pos) {
+                if (boundary[pos] != vertex && clique[row + pos] != INF_WEIGHT) {
+                    callback(boundary[pos], clique[row + pos],
+                             Arc{ vertex, NO_EDGE, static_cast<uint32_t>(level), cell });
+                }
+            }
+        }
+
+        // edges inside the cell are replaced by the clique
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+
+            if (level == 0 || GetCell(level, edge.to) != GetCell(level, vertex)) {
+                callback(edge.to, metric.edge_weights[edge_id], Arc{ vertex, edge_id, 0, 0 });
+            }
+        }
+    }
+
+    template <typename LevelOf, typename IsAllowed>
+    void OverlayRouter::Search(const Metric& metric, SearchSpace& space, VertexId source, std::optional<VertexId> target,
+                               LevelOf level_of, IsAllowed is_allowed) const {
+        using QueueItem = std::pair<double, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>> queue;
+
+        space.weights[source] = 0.0;
+        space.touched.push_back(source);
+        queue.emplace(0.0, source);
+
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+
+            if (weight > space.weights[vertex]) {
+                continue; // outdated queue item
+            }
+
+            if (target && vertex == *target) {
+                break;
+            }
+
+            ForEachArc(metric, vertex, level_of(vertex), [&](VertexId to, double arc_weight, const Arc& arc) {
+                if (!is_allowed(to)) {
+                    return;
+                }
+
+                const double candidate_weight = weight + arc_weight;
+                if (candidate_weight < space.weights[to]) {
+                    if (space.weights[to] == INF_WEIGHT) {
+                        space.touched.push_back(to);
+                    }
+
+                    space.weights[to] = candidate_weight;
+                    space.arcs[to] = arc;
+                    queue.emplace(candidate_weight, to);
+                }
+            });
+        }
+    }
+
+    std::shared_ptr<const OverlayRouter::Metric> OverlayRouter::Customize(std::vector<double> edge_weights) const {
+        if (edge_weights.size() != graph_.GetEdgeCount()) {
+            throw std::invalid_argument("Weights are required for every edge"s);
+        }
+
+        if (std::any_of(edge_weights.begin(), edge_weights.end(), [](double weight) { return weight < 0.0; })) {
+            throw std::domain_error("Edges' weights should be non-negative"s);
+        }
+
+        auto metric = std::make_shared<Metric>();
+        metric->edge_weights = std::move(edge_weights);
+        metric->cliques.resize(level_cell_sizes_.size());
+
+        SearchSpace space(graph_.GetVertexCount());
+
+        // every level is built from the cliques of the level below
+        for (size_t level = 1; level <= level_cell_sizes_.size(); ++level) {
+            const size_t level_idx = level - 1;
+            auto& level_cliques = metric->cliques[level_idx];
+            level_cliques.resize(boundaries_[level_idx].size());
+
+            for (uint32_t cell = 0; cell < boundaries_[level_idx].size(); ++cell) {
+                const auto& boundary = boundaries_[level_idx][cell];
+                auto& clique = level_cliques[cell];
+                clique.assign(boundary.size() * boundary.size(), INF_WEIGHT);
+
+                for (size_t from_pos = 0; from_pos < boundary.size(); ++from_pos) {
+                    Search(
+                            *metric, space, boundary[from_pos], std::nullopt,
+                            [level](VertexId) { return level - 1; },
+                            [this, level_idx, cell](VertexId vertex) { return cells_[level_idx][vertex] == cell; });
+
+                    for (size_t to_pos = 0; to_pos < boundary.size(); ++to_pos) {
+                        clique[from_pos * boundary.size() + to_pos] = space.weights[boundary[to_pos]];
+                    }
+
+                    space.Reset();
+                }
+            }
+        }
+
+        return metric;
+    }
+
+    std::optional<OverlayRouter::RouteInfo> OverlayRouter::BuildRoute(const Metric& metric, VertexId from,
+                                                                      VertexId to) const {
+        SearchSpace space(graph_.GetVertexCount());
+
+        Search(
+                metric, space, from, to,
+                [this, from, to](VertexId vertex) { return GetQueryLevel(vertex, from, to); },
+                [](VertexId) { return true; });
+
+        if (space.weights[to] == INF_WEIGHT) {
+            return std::nullopt;
+        }
+
+        RouteInfo route_info{ space.weights[to], {} };
+        Unpack(metric, space, from, to, route_info.edges);
+
+        return route_info;
+    }
+
+    void OverlayRouter::Unpack(const Metric& metric, SearchSpace& space, VertexId source, VertexId target,
+                               std::vector<EdgeId>& edges) const {
+        std::vector<Arc> path;
+        for (VertexId vertex = target; vertex != source; vertex = space.arcs[vertex].from) {
+            path.push_back(space.arcs[vertex]);
+        }
+
+        std::reverse(path.begin(), path.end());
+
+        // the path is copied, so the space is free for unpacking searches
+        space.Reset();
+
+        for (size_t i = 0; i < path.size(); ++i) {
+            const Arc& arc = path[i];
+
+            if (arc.edge != NO_EDGE) {
+                edges.push_back(arc.edge);
+                continue;
+            }
+
+            const VertexId shortcut_end = i + 1 < path.size() ? path[i + 1].from : target;
+            UnpackShortcut(metric, space, arc.level, arc.cell, arc.from, shortcut_end, edges);
+        }
+    }
+
+    void OverlayRouter::UnpackShortcut(const Metric& metric, SearchSpace& space, uint32_t level, uint32_t cell,
+                                       VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+        // repeat the customization search which gave the shortcut weight
+        Search(
+                metric, space, from, to,
+                [level](VertexId) { return level - 1; },
+                [this, level, cell](VertexId vertex) { return GetCell(level, vertex) == cell; });
+
+        Unpack(metric, space, from, to, edges);
+    }
+
+} // namespace graph
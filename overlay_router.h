@@ -0,0 +1,98 @@
+#pragma once
+
+#include "dijkstra.h"
+#include "geo.h"
+#include "graph.h"
+#include "router_base.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace graph {
+
+    /*
+    Customizable multi-level overlay router.
+    Preprocessing is metric-independent: vertices are split into nested cells by recursive
+    bisection of their coordinates and boundary vertices of every cell are found.
+    Customization applies a metric (weights of all edges) by computing shortest paths
+    between boundary vertices inside every cell, bottom-up, so it takes a few local searches per cell.
+    A query searches the original graph only inside the cells of its endpoints and uses
+    the coarsest cells' shortcuts elsewhere.
+    */
+    class OverlayRouter {
+    public:
+        using Graph = DirectedWeightedGraph<double>;
+        using RouteInfo = RouterBase<double>::RouteInfo;
+
+        // Metric-dependent data
+        struct Metric {
+            std::vector<double> edge_weights;
+            // distances between boundary vertices of a cell inside it: [level][cell][from_pos * boundary_size + to_pos]
+            std::vector<std::vector<std::vector<double>>> cliques;
+        };
+
+        OverlayRouter(const Graph& graph, const std::vector<geo::Coordinates>& vertex_coordinates);
+
+        // edge_weights are indexed by EdgeId and must be non-negative
+        std::shared_ptr<const Metric> Customize(std::vector<double> edge_weights) const;
+
+        std::optional<RouteInfo> BuildRoute(const Metric& metric, VertexId from, VertexId to) const;
+
+        size_t GetLevelsCount() const;
+
+    private:
+        static constexpr uint32_t NO_POS = UINT32_MAX;
+        static constexpr size_t FINEST_CELL_SIZE = 16;
+        static constexpr size_t CELL_SIZE_FACTOR = 8;
+
+        // How a vertex was reached: an original edge or a shortcut of level (1-based) cell
+        struct Arc {
+            VertexId from{};
+            EdgeId edge = NO_EDGE;
+            uint32_t level{};
+            uint32_t cell{};
+        };
+
+        struct SearchSpace {
+            explicit SearchSpace(size_t vertex_count);
+
+            void Reset();
+
+            std::vector<double> weights;
+            std::vector<Arc> arcs;
+            std::vector<VertexId> touched;
+        };
+
+        void Partition(const std::vector<geo::Coordinates>& vertex_coordinates);
+        void FindBoundaries();
+
+        uint32_t GetCell(size_t level, VertexId vertex) const;
+        size_t GetQueryLevel(VertexId vertex, VertexId from, VertexId to) const;
+
+        // Calls callback(to, weight, arc) for every arc of the overlay graph of a level leaving the vertex.
+        // Level 0 is the original graph, at level l the vertex must be a boundary one of its l-level cell
+        template <typename Callback>
+        void ForEachArc(const Metric& metric, VertexId vertex, size_t level, Callback callback) const;
+
+        template <typename LevelOf, typename IsAllowed>
+        void Search(const Metric& metric, SearchSpace& space, VertexId source, std::optional<VertexId> target,
+                    LevelOf level_of, IsAllowed is_allowed) const;
+
+        // Appends original edges of the path from source to target found by the last search in the space
+        void Unpack(const Metric& metric, SearchSpace& space, VertexId source, VertexId target,
+                    std::vector<EdgeId>& edges) const;
+        void UnpackShortcut(const Metric& metric, SearchSpace& space, uint32_t level, uint32_t cell,
+                            VertexId from, VertexId to, std::vector<EdgeId>& edges) const;
+
+    private:
+        const Graph& graph_;
+
+        std::vector<size_t> level_cell_sizes_;
+        std::vector<std::vector<uint32_t>> cells_;                 // [level - 1][vertex]
+        std::vector<std::vector<std::vector<VertexId>>> boundaries_; // [level - 1][cell]
+        std::vector<std::vector<uint32_t>> boundary_positions_;      // [level - 1][vertex]
+    };
+
+} // namespace graph
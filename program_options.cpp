@@ -0,0 +1,72 @@
+#include "program_options.h"
+
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+using namespace std::literals;
+
+namespace {
+
+    // Value of "--name=value" or of "--name value", the index is moved past the value
+    std::string ReadOptionValue(std::string_view arg, std::string_view name, int& idx, int argc, char* argv[]) {
+        if (arg.size() > name.size() && arg[name.size()] == '=') {
+            return std::string(arg.substr(name.size() + 1));
+        }
+
+        if (++idx >= argc) {
+            throw std::invalid_argument("Option "s + std::string(name) + " requires a value"s);
+        }
+
+        return argv[idx];
+    }
+
+    bool IsOption(std::string_view arg, std::string_view name) {
+        return arg.substr(0, name.size()) == name && (arg.size() == name.size() || arg[name.size()] == '=');
+    }
+
+    size_t ReadCount(const std::string& value, std::string_view name) {
+        size_t count = 0;
+        const auto [ptr, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+
+        if (error != std::errc{} || ptr != value.data() + value.size() || count == 0) {
+            throw std::invalid_argument("Option "s + std::string(name) + " requires a positive number"s);
+        }
+
+        return count;
+    }
+
+} // namespace
+
+Program_options ParseProgramOptions(int argc, char* argv[]) {
+    Program_options options;
+
+    for (int idx = 1; idx < argc; ++idx) {
+        const std::string_view arg = argv[idx];
+
+        if (IsOption(arg, "--input"sv)) {
+            options.input_file = ReadOptionValue(arg, "--input"sv, idx, argc, argv);
+        } else if (IsOption(arg, "--parse-threads"sv)) {
+            options.parse_threads = ReadCount(ReadOptionValue(arg, "--parse-threads"sv, idx, argc, argv), "--parse-threads"sv);
+        } else if (IsOption(arg, "--answer-threads"sv)) {
+            options.answer_threads = ReadCount(ReadOptionValue(arg, "--answer-threads"sv, idx, argc, argv), "--answer-threads"sv);
+        } else if (IsOption(arg, "--threads"sv)) {
+            options.threads = ReadCount(ReadOptionValue(arg, "--threads"sv, idx, argc, argv), "--threads"sv);
+        } else if (IsOption(arg, "--serve"sv)) {
+            options.serve_address = ReadOptionValue(arg, "--serve"sv, idx, argc, argv);
+        } else if (arg == "--sax"sv) {
+            options.sax_input = true;
+        } else if (arg == "--pipeline"sv) {
+            options.pipeline = true;
+            options.sax_input = true;
+        } else if (arg == "--compact-output"sv) {
+            options.compact_output = true;
+        } else if (arg == "--shortest-doubles"sv) {
+            options.shortest_doubles = true;
+        } else {
+            throw std::invalid_argument("Unknown option "s + std::string(arg));
+        }
+    }
+
+    return options;
+}
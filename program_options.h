@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+struct Program_options {
+    std::string input_file; // stdin if empty
+    bool sax_input = false; // stream the input into the catalogue instead of building a document
+    bool pipeline = false; // answer stat requests as they are read, implies sax_input
+    size_t parse_threads = 1; // threads parsing items of large arrays of the document
+    size_t answer_threads = 1; // threads answering collected stat requests
+    size_t threads = 0; // threads of the build phases, hardware concurrency if 0
+    bool compact_output = false; // answers without line breaks and indents
+    bool shortest_doubles = false; // the shortest round-trip form of doubles instead of 6 significant digits
+    std::string serve_address; // Unix domain socket path or localhost TCP port to serve requests on after the input
+};
+
+// Accepts "--input <path>", "--parse-threads <count>", "--answer-threads <count>", "--threads <count>",
+// "--serve <socket path or port>" (also as "--name=value"),
+// "--sax", "--pipeline", "--compact-output" and "--shortest-doubles",
+// throws std::invalid_argument on anything else
+Program_options ParseProgramOptions(int argc, char* argv[]);
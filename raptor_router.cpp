@@ -0,0 +1,253 @@
+#include "raptor_router.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+RaptorRouter::RaptorRouter(const tc::TransportCatalogue& transport_catalogue, const Routing_settings& routing_settings)
+    : transport_catalogue_(transport_catalogue)
+    , routing_settings_(routing_settings) {
+
+    for (const Bus& bus : transport_catalogue_.GetAllBuses()) {
+        if (bus.departures.empty() || bus.stops.size() < 2) {
+            continue;
+        }
+
+        std::vector<const Stop*> stops;
+        for (const auto& stop_name : bus.stops) {
+            stops.push_back(transport_catalogue_.GetStopByName(stop_name));
+        }
+
+        AddPattern(bus, stops);
+
+        // line bus goes back by the same timetable from the last stop
+        if (!bus.is_roundtrip) {
+            std::reverse(stops.begin(), stops.end());
+            AddPattern(bus, stops);
+        }
+    }
+
+    IndexStopPatterns();
+}
+
+bool RaptorRouter::HasTimetables() const {
+    return !patterns_.empty();
+}
+
+void RaptorRouter::AddPattern(const Bus& bus, const std::vector<const Stop*>& stops) {
+    Pattern pattern;
+    pattern.bus = &bus;
+    pattern.stops_offset = static_cast<uint32_t>(pattern_stops_.size());
+    pattern.stops_count = static_cast<uint32_t>(stops.size());
+    pattern.times_offset = static_cast<uint32_t>(stop_times_.size());
+    pattern.trips_count = static_cast<uint32_t>(bus.departures.size());
+
+    // time from the first stop to every stop of the pattern
+    std::vector<double> stop_offsets(stops.size(), 0.0);
+
+    for (size_t i = 0; i < stops.size(); ++i) {
+        pattern_stops_.push_back(transport_catalogue_.GetStopIndex(stops[i]));
+
+        if (i > 0) {
+            auto distance = transport_catalogue_.GetDistanceByStopsPair(stops[i - 1], stops[i]);
+            if (distance == std::nullopt) {
+                throw std::logic_error("Can't find stops distance"s);
+            }
+
+            stop_offsets[i] = stop_offsets[i - 1] + distance.value() / routing_settings_.bus_velocity;
+        }
+    }
+
+    // trips of a pattern never overtake each other, so sorted departures give sorted times at every stop
+    std::vector<double> departures = bus.departures;
+    std::sort(departures.begin(), departures.end());
+
+    for (double departure : departures) {
+        for (double stop_offset : stop_offsets) {
+            stop_times_.push_back(departure + stop_offset);
+        }
+    }
+
+    patterns_.push_back(pattern);
+}
+
+void RaptorRouter::IndexStopPatterns() {
+    const size_t stops_count = transport_catalogue_.GetAllStopsCount();
+
+    stop_patterns_offsets_.assign(stops_count + 1, 0);
+
+    for (graph::VertexId stop : pattern_stops_) {
+        ++stop_patterns_offsets_[stop + 1];
+    }
+
+    for (size_t i = 0; i < stops_count; ++i) {
+        stop_patterns_offsets_[i + 1] += stop_patterns_offsets_[i];
+    }
+
+    stop_patterns_.resize(pattern_stops_.size());
+    std::vector<uint32_t> fill_positions(stop_patterns_offsets_.begin(), stop_patterns_offsets_.end() - 1);
+
+    for (uint32_t pattern_idx = 0; pattern_idx < patterns_.size(); ++pattern_idx) {
+        const Pattern& pattern = patterns_[pattern_idx];
+
+        for (uint32_t pos = 0; pos < pattern.stops_count; ++pos) {
+            const graph::VertexId stop = pattern_stops_[pattern.stops_offset + pos];
+            stop_patterns_[fill_positions[stop]++] = { pattern_idx, pos };
+        }
+    }
+}
+
+double RaptorRouter::GetStopTime(const Pattern& pattern, uint32_t trip, uint32_t pos) const {
+    return stop_times_[pattern.times_offset + trip * pattern.stops_count + pos];
+}
+
+std::optional<uint32_t> RaptorRouter::FindEarliestTrip(const Pattern& pattern, uint32_t pos, double ready_time) const {
+    // binary search over trips, their times at any stop are sorted
+    uint32_t left = 0;
+    uint32_t right = pattern.trips_count;
+
+    while (left < right) {
+        const uint32_t middle = left + (right - left) / 2;
+
+        if (GetStopTime(pattern, middle, pos) < ready_time) {
+            left = middle + 1;
+        } else {
+            right = middle;
+        }
+    }
+
+    if (left == pattern.trips_count) {
+        return std::nullopt;
+    }
+
+    return left;
+}
+
+std::optional<Journey> RaptorRouter::FindEarliestArrival(graph::VertexId from, graph::VertexId to,
+                                                         double departure_time) const {
+    constexpr double NOT_REACHED = std::numeric_limits<double>::infinity();
+    constexpr uint32_t NOT_MARKED = std::numeric_limits<uint32_t>::max();
+
+    const size_t stops_count = transport_catalogue_.GetAllStopsCount();
+
+    // arrivals and labels of round k are stored at [k * stops_count + stop]
+    std::vector<double> round_arrivals((MAX_ROUNDS + 1) * stops_count, NOT_REACHED);
+    std::vector<Label> labels((MAX_ROUNDS + 1) * stops_count);
+    std::vector<double> best_arrivals(stops_count, NOT_REACHED);
+
+    std::vector<bool> is_marked(stops_count, false);
+    std::vector<graph::VertexId> marked_stops;
+
+    // earliest marked position for every pattern to scan in current round
+    std::vector<uint32_t> patterns_to_scan(patterns_.size(), NOT_MARKED);
+    std::vector<uint32_t> queued_patterns;
+
+    round_arrivals[from] = departure_time;
+    best_arrivals[from] = departure_time;
+    marked_stops.push_back(from);
+    is_marked[from] = true;
+
+    size_t rounds = 0;
+
+    for (size_t round = 1; round <= MAX_ROUNDS && !marked_stops.empty(); ++round) {
+        const double* prev_arrivals = &round_arrivals[(round - 1) * stops_count];
+        double* arrivals = &round_arrivals[round * stops_count];
+        Label* round_labels = &labels[round * stops_count];
+
+        queued_patterns.clear();
+        for (graph::VertexId stop : marked_stops) {
+            is_marked[stop] = false;
+
+            for (uint32_t i = stop_patterns_offsets_[stop]; i < stop_patterns_offsets_[stop + 1]; ++i) {
+                const auto [pattern_idx, pos] = stop_patterns_[i];
+
+                if (patterns_to_scan[pattern_idx] == NOT_MARKED) {
+                    queued_patterns.push_back(pattern_idx);
+                    patterns_to_scan[pattern_idx] = pos;
+                } else {
+                    patterns_to_scan[pattern_idx] = std::min(patterns_to_scan[pattern_idx], pos);
+                }
+            }
+        }
+        marked_stops.clear();
+
+        for (uint32_t pattern_idx : queued_patterns) {
+            const Pattern& pattern = patterns_[pattern_idx];
+            const graph::VertexId* stops = &pattern_stops_[pattern.stops_offset];
+
+            std::optional<uint32_t> trip;
+            uint32_t board_pos = 0;
+
+            for (uint32_t pos = patterns_to_scan[pattern_idx]; pos < pattern.stops_count; ++pos) {
+                const graph::VertexId stop = stops[pos];
+
+                if (trip) {
+                    const double arrival = GetStopTime(pattern, *trip, pos);
+
+                    // arrivals later than the known target arrival are useless
+                    if (arrival < std::min(best_arrivals[stop], best_arrivals[to])) {
+                        arrivals[stop] = arrival;
+                        best_arrivals[stop] = arrival;
+                        round_labels[stop] = { pattern_idx, *trip, board_pos, pos };
+
+                        if (!is_marked[stop]) {
+                            is_marked[stop] = true;
+                            marked_stops.push_back(stop);
+                        }
+                    }
+                }
+
+                // an earlier trip may be caught at this stop
+                if (prev_arrivals[stop] != NOT_REACHED
+                    && (!trip || prev_arrivals[stop] <= GetStopTime(pattern, *trip, pos))) {
+                    if (auto earlier_trip = FindEarliestTrip(pattern, pos, prev_arrivals[stop]);
+                        earlier_trip && (!trip || *earlier_trip < *trip)) {
+                        trip = earlier_trip;
+                        board_pos = pos;
+                    }
+                }
+            }
+
+            patterns_to_scan[pattern_idx] = NOT_MARKED;
+        }
+
+        rounds = round;
+    }
+
+    if (best_arrivals[to] == NOT_REACHED) {
+        return std::nullopt;
+    }
+
+    Journey journey;
+    journey.departure_time = departure_time;
+    journey.arrival_time = best_arrivals[to];
+
+    // the fewest trips round which gives the best arrival
+    size_t round = 0;
+    while (round_arrivals[round * stops_count + to] != best_arrivals[to]) {
+        ++round;
+    }
+
+    for (graph::VertexId stop = to; round > 0 && round <= rounds; --round) {
+        const Label& label = labels[round * stops_count + stop];
+        const Pattern& pattern = patterns_[label.pattern];
+
+        Journey_leg leg;
+        leg.bus = pattern.bus;
+        leg.board_stop = pattern_stops_[pattern.stops_offset + label.board_pos];
+        leg.alight_stop = stop;
+        leg.departure_time = GetStopTime(pattern, label.trip, label.board_pos);
+        leg.arrival_time = GetStopTime(pattern, label.trip, label.alight_pos);
+        leg.wait_time = leg.departure_time - round_arrivals[(round - 1) * stops_count + leg.board_stop];
+        leg.span_count = static_cast<int>(label.alight_pos - label.board_pos);
+
+        journey.legs.push_back(leg);
+        stop = leg.board_stop;
+    }
+
+    std::reverse(journey.legs.begin(), journey.legs.end());
+
+    return journey;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "graph.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+struct Routing_settings;
+
+struct Journey_leg {
+    const Bus* bus = nullptr;
+    graph::VertexId board_stop{};
+    graph::VertexId alight_stop{};
+    double wait_time{};      // at board stop since arrival there
+    double departure_time{}; // minutes after midnight
+    double arrival_time{};
+    int span_count{};
+};
+
+struct Journey {
+    double departure_time{};
+    double arrival_time{};
+    std::vector<Journey_leg> legs;
+};
+
+/*
+Round-based (RAPTOR) router over bus timetables. Round k finds the earliest arrivals
+with k trips. Every round scans only the patterns serving stops improved in the previous
+round, and all stops and trip times of a pattern are kept in contiguous arrays.
+*/
+class RaptorRouter {
+public:
+    RaptorRouter(const tc::TransportCatalogue& transport_catalogue, const Routing_settings& routing_settings);
+
+    // False if no bus has a timetable
+    bool HasTimetables() const;
+
+    std::optional<Journey> FindEarliestArrival(graph::VertexId from, graph::VertexId to, double departure_time) const;
+
+private:
+    // Stops sequence of a bus in one direction with all its trips
+    struct Pattern {
+        const Bus* bus = nullptr;
+        uint32_t stops_offset{}; // in pattern_stops_
+        uint32_t stops_count{};
+        uint32_t times_offset{}; // in stop_times_, trip-major
+        uint32_t trips_count{};
+    };
+
+    // How a stop was reached in a round
+    struct Label {
+        uint32_t pattern{};
+        uint32_t trip{};
+        uint32_t board_pos{};
+        uint32_t alight_pos{};
+    };
+
+    static constexpr size_t MAX_ROUNDS = 8;
+
+    void AddPattern(const Bus& bus, const std::vector<const Stop*>& stops);
+    void IndexStopPatterns();
+
+    double GetStopTime(const Pattern& pattern, uint32_t trip, uint32_t pos) const;
+    std::optional<uint32_t> FindEarliestTrip(const Pattern& pattern, uint32_t pos, double ready_time) const;
+
+private:
+    const tc::TransportCatalogue& transport_catalogue_;
+    const Routing_settings& routing_settings_;
+
+    std::vector<Pattern> patterns_;
+    std::vector<graph::VertexId> pattern_stops_;
+    std::vector<double> stop_times_;
+
+    // patterns passing through each stop with the stop position in pattern, CSR layout
+    std::vector<uint32_t> stop_patterns_offsets_;
+    std::vector<std::pair<uint32_t, uint32_t>> stop_patterns_;
+};
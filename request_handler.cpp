@@ -1,9 +1,10 @@
 #include "request_handler.h"
 
 #include <cmath>
+#include <tuple>
 
 RequestHandler::RequestHandler(const tc::TransportCatalogue &transport_catalogue, const MapRenderer &renderer,
-                               const graph::Router<double> &router, const Transport_router &transport_router)
+                               const graph::RouterBase<double> &router, const Transport_router &transport_router)
     : transport_catalogue_(transport_catalogue)
     , renderer_(renderer)
     , router_(router)
@@ -13,6 +14,12 @@ RequestHandler::RequestHandler(const tc::TransportCatalogue &transport_catalogue
         sorted_unique_stopnames_.insert(stop.name);
     }
 
+    UpdateBuses();
+}
+
+void RequestHandler::UpdateBuses() {
+    sorted_buses_.clear();
+
     // Don't use std::set - buses may be added more than one time
     for (const Bus& bus : transport_catalogue_.GetAllBuses()) {
         sorted_buses_.push_back(&bus);
@@ -60,22 +67,8 @@ Bus_Route_Stat RequestHandler::GetBusStat(const std::string_view bus_name) const
     return bus_route;
 }
 
-BusesToStop RequestHandler::GetBusesByStop(const std::string_view stop_name) const {
-    BusesToStop b2s;
-
-    b2s.stop_name = stop_name;
-
-    const Stop* stop = transport_catalogue_.GetStopByName(stop_name);
-    if (stop == nullptr) {
-        b2s.notFound = true;
-        return b2s;
-    } else {
-        b2s.notFound = false;
-    }
-
-    b2s.buses = transport_catalogue_.GetBusesToStop(stop);
-
-    return b2s;
+const std::set<std::string_view>& RequestHandler::GetBusesByStop(const Stop* stop) const {
+    return transport_catalogue_.GetBusesToStop(stop);
 }
 
 svg::Document RequestHandler::RenderMap() const {
@@ -185,6 +178,10 @@ svg::Document RequestHandler::RenderMap() const {
     return doc;
 }
 
+const Routing_settings& RequestHandler::GetRoutingSettings() const {
+    return transport_router_.GetRouterSettings();
+}
+
 // ----Auxiliary private methods----
 double RequestHandler::CalculateGPSLength(const Bus* bus) const {
 
@@ -239,24 +236,278 @@ int RequestHandler::GetUniqueStopsCount(const Bus* bus) {
     return static_cast<int>(unique_stops.size());
 }
 
-std::optional<Route_Stat> RequestHandler::GetRoute(std::string_view from, std::string_view to) const {
-    const Routing_settings routing_settings = transport_router_.GetRouterSettings();
+std::optional<Route_Stat> RequestHandler::GetRoute(const Stop* stop_from, const Stop* stop_to) const {
+    if (stop_from == nullptr || stop_to == nullptr) {
+        return std::nullopt;
+    }
 
-    const Stop* stop_from = transport_catalogue_.GetStopByName(from);
-    const Stop* stop_to = transport_catalogue_.GetStopByName(to);
+    graph::VertexId idx_stop_from = transport_catalogue_.GetStopIndex(stop_from);
+    graph::VertexId idx_stop_to = transport_catalogue_.GetStopIndex(stop_to);
+
+    std::optional<graph::RouterBase<double>::RouteInfo> route_info = router_.BuildRoute(idx_stop_from, idx_stop_to);
+
+    if (route_info == std::nullopt) {
+        return std::nullopt;
+    }
+
+    return MakeRouteStat(route_info.value(), transport_router_.GetRouterSettings());
+}
+
+std::optional<double> RequestHandler::GetRouteTime(const Stop* stop_from, const Stop* stop_to) const {
+    if (stop_from == nullptr || stop_to == nullptr) {
+        return std::nullopt;
+    }
 
     graph::VertexId idx_stop_from = transport_catalogue_.GetStopIndex(stop_from);
     graph::VertexId idx_stop_to = transport_catalogue_.GetStopIndex(stop_to);
 
-    std::optional<graph::Router<double>::RouteInfo> route_info = router_.BuildRoute(idx_stop_from, idx_stop_to);
+    if (const graph::HubLabels* hub_labels = transport_router_.GetHubLabels()) {
+        return hub_labels->GetWeight(idx_stop_from, idx_stop_to);
+    }
+
+    std::optional<graph::RouterBase<double>::RouteInfo> route_info = router_.BuildRoute(idx_stop_from, idx_stop_to);
+
+    if (route_info == std::nullopt) {
+        return std::nullopt;
+    }
+
+    return route_info->weight;
+}
+
+std::optional<Route_Stat> RequestHandler::GetRoute(const Stop* stop_from, const Stop* stop_to,
+                                                   const Routing_settings& routing_settings) const {
+    if (stop_from == nullptr || stop_to == nullptr) {
+        return std::nullopt;
+    }
+
+    const auto metric = transport_router_.GetOverlayMetric(routing_settings);
+
+    std::optional<graph::RouterBase<double>::RouteInfo> route_info = transport_router_.GetOverlayRouter().BuildRoute(
+            *metric, transport_catalogue_.GetStopIndex(stop_from), transport_catalogue_.GetStopIndex(stop_to));
 
     if (route_info == std::nullopt) {
         return std::nullopt;
     }
 
+    return MakeRouteStat(route_info.value(), routing_settings);
+}
+
+std::optional<Route_Stat> RequestHandler::GetRoute(const Stop* stop_from, const Stop* stop_to, double departure_time) const {
+    const RaptorRouter* timetable_router = transport_router_.GetTimetableRouter();
+
+    if (timetable_router == nullptr || stop_from == nullptr || stop_to == nullptr) {
+        return std::nullopt;
+    }
+
+    std::optional<Journey> journey = timetable_router->FindEarliestArrival(
+            transport_catalogue_.GetStopIndex(stop_from), transport_catalogue_.GetStopIndex(stop_to), departure_time);
+
+    if (journey == std::nullopt) {
+        return std::nullopt;
+    }
+
     Route_Stat route_stat;
 
-    const std::vector<graph::EdgeId> edges = route_info.value().edges;
+    for (const Journey_leg& leg : journey->legs) {
+        Route_Element wait_element;
+        wait_element.stop_name = transport_catalogue_.GetStopByIndex(leg.board_stop)->name;
+        wait_element.time = leg.wait_time;
+        wait_element.type = "Wait"s;
+        route_stat.items.push_back(std::move(wait_element));
+
+        Route_Element go_element;
+        go_element.time = leg.arrival_time - leg.departure_time;
+        go_element.type = "Bus"s;
+        go_element.bus_name = leg.bus->name;
+        go_element.span_count = leg.span_count;
+        route_stat.items.push_back(std::move(go_element));
+    }
+
+    route_stat.total_time = journey->arrival_time - journey->departure_time;
+
+    return route_stat;
+}
+
+std::vector<std::optional<Route_Stat>> RequestHandler::GetRoutes(const Stop* stop_from,
+                                                                 const std::vector<const Stop*>& destinations) const {
+    std::vector<std::optional<Route_Stat>> routes(destinations.size());
+
+    if (stop_from == nullptr) {
+        return routes;
+    }
+
+    // unknown destinations stay unanswered and are not searched for
+    std::vector<graph::VertexId> targets;
+    std::vector<size_t> target_positions;
+
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        if (destinations[i] != nullptr) {
+            targets.push_back(transport_catalogue_.GetStopIndex(destinations[i]));
+            target_positions.push_back(i);
+        }
+    }
+
+    if (targets.empty()) {
+        return routes;
+    }
+
+    // the router searches once for all targets, the lazy one reuses and fills its cache of trees
+    std::vector<std::optional<graph::RouterBase<double>::RouteInfo>> route_infos =
+            router_.BuildRoutes(transport_catalogue_.GetStopIndex(stop_from), targets);
+
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (route_infos[i]) {
+            routes[target_positions[i]] = MakeRouteStat(route_infos[i].value(), transport_router_.GetRouterSettings());
+        }
+    }
+
+    return routes;
+}
+
+std::vector<std::vector<std::optional<double>>> RequestHandler::GetTravelTimes(const std::vector<const Stop*>& sources,
+                                                                               const std::vector<const Stop*>& targets) const {
+    std::vector<std::vector<std::optional<double>>> travel_times(sources.size(),
+                                                                 std::vector<std::optional<double>>(targets.size()));
+
+    // resolve target stops once for all rows
+    std::vector<std::optional<graph::VertexId>> target_indexes(targets.size());
+    std::vector<graph::VertexId> known_targets;
+
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (const Stop* stop_to = targets[i]) {
+            target_indexes[i] = transport_catalogue_.GetStopIndex(stop_to);
+            known_targets.push_back(*target_indexes[i]);
+        }
+    }
+
+    if (known_targets.empty()) {
+        return travel_times;
+    }
+
+    const auto& routes_graph = transport_router_.GetGraph();
+
+    for (size_t row = 0; row < sources.size(); ++row) {
+        const Stop* stop_from = sources[row];
+        if (stop_from == nullptr) {
+            continue;
+        }
+
+        const graph::ShortestPathTree<double> tree =
+                graph::BuildShortestPathTree(routes_graph, transport_catalogue_.GetStopIndex(stop_from), known_targets);
+
+        for (size_t col = 0; col < targets.size(); ++col) {
+            if (target_indexes[col] && tree.IsReached(*target_indexes[col])) {
+                travel_times[row][col] = tree.weights[*target_indexes[col]];
+            }
+        }
+    }
+
+    return travel_times;
+}
+
+std::optional<Route_Stat> RequestHandler::GetRoute(geo::Coordinates from, geo::Coordinates to) const {
+    const double walking_velocity = transport_router_.GetRouterSettings().walking_velocity;
+
+    const auto sources = GetWalkingTimesToStops(from);
+    const auto targets = GetWalkingTimesToStops(to);
+
+    std::optional<Route_Stat> best_route;
+
+    if (!sources.empty() && !targets.empty()) {
+        const auto& routes_graph = transport_router_.GetGraph();
+
+        if (auto route_info = graph::FindBestRoute(routes_graph, sources, targets)) {
+            const auto find_offset = [](const auto& stops_times, graph::VertexId vertex) {
+                return std::find_if(stops_times.begin(), stops_times.end(), [vertex](const auto& stop_time) {
+                    return stop_time.first == vertex;
+                })->second;
+            };
+
+            const double walk_to_stop_time = find_offset(sources, route_info->source);
+            const double walk_from_stop_time = find_offset(targets, route_info->target);
+
+            best_route = MakeRouteStat({ route_info->weight - walk_to_stop_time - walk_from_stop_time,
+                                         std::move(route_info->edges) },
+                                       transport_router_.GetRouterSettings());
+
+            Route_Element walk_to_stop;
+            walk_to_stop.type = "Walk"s;
+            walk_to_stop.to_stop_name = transport_catalogue_.GetStopByIndex(route_info->source)->name;
+            walk_to_stop.time = walk_to_stop_time;
+            best_route->items.push_front(std::move(walk_to_stop));
+
+            Route_Element walk_from_stop;
+            walk_from_stop.type = "Walk"s;
+            walk_from_stop.stop_name = transport_catalogue_.GetStopByIndex(route_info->target)->name;
+            walk_from_stop.time = walk_from_stop_time;
+            best_route->items.push_back(std::move(walk_from_stop));
+
+            best_route->total_time = route_info->weight;
+            best_route->bus_wait_time = transport_router_.GetRouterSettings().bus_wait_time;
+        }
+    }
+
+    // walking all the way may be the best choice for close points
+    const double walk_time = geo::ComputeDistance(from, to) / walking_velocity;
+
+    if (!best_route || walk_time <= best_route->total_time) {
+        Route_Stat walk_route;
+
+        Route_Element walk;
+        walk.type = "Walk"s;
+        walk.time = walk_time;
+        walk_route.items.push_back(std::move(walk));
+
+        walk_route.total_time = walk_time;
+
+        return walk_route;
+    }
+
+    return best_route;
+}
+
+std::vector<std::pair<graph::VertexId, double>> RequestHandler::GetWalkingTimesToStops(geo::Coordinates point) const {
+    const Routing_settings& routing_settings = transport_router_.GetRouterSettings();
+
+    std::vector<std::pair<graph::VertexId, double>> walking_times;
+
+    for (const auto& [stop_idx, distance] : transport_router_.GetStopsGrid().FindWithin(point, routing_settings.stop_search_radius)) {
+        walking_times.emplace_back(stop_idx, distance / routing_settings.walking_velocity);
+    }
+
+    return walking_times;
+}
+
+std::optional<std::vector<std::pair<std::string_view, double>>> RequestHandler::GetReachableStops(const Stop* stop_from,
+                                                                                                  double time_budget) const {
+    if (stop_from == nullptr) {
+        return std::nullopt;
+    }
+
+    // the search does not go beyond the budget, so every reached stop is in the answer
+    const graph::ShortestPathTree<double> tree = graph::BuildShortestPathTree(
+            transport_router_.GetGraph(), transport_catalogue_.GetStopIndex(stop_from), {}, time_budget);
+
+    std::vector<std::pair<std::string_view, double>> reachable_stops;
+
+    for (graph::VertexId vertex = 0; vertex < tree.weights.size(); ++vertex) {
+        if (tree.IsReached(vertex)) {
+            reachable_stops.emplace_back(transport_catalogue_.GetStopByIndex(vertex)->name, tree.weights[vertex]);
+        }
+    }
+
+    std::sort(reachable_stops.begin(), reachable_stops.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+    });
+
+    return reachable_stops;
+}
+
+Route_Stat RequestHandler::MakeRouteStat(const graph::RouterBase<double>::RouteInfo& route_info,
+                                         const Routing_settings& routing_settings) const {
+    Route_Stat route_stat;
+
+    const std::vector<graph::EdgeId>& edges = route_info.edges;
 
     double total_time = 0.0;
 
@@ -268,7 +519,23 @@ std::optional<Route_Stat> RequestHandler::GetRoute(std::string_view from, std::s
     }
 
     for (const auto& edgeID : edges) {
-        Edge_props props = transport_router_.GetEdgeProps(edgeID);
+        const Edge_props& props = transport_router_.GetEdgeProps(edgeID);
+
+        if (props.bus == nullptr) {
+            Route_Element walk_element;
+            walk_element.type = "Walk"s;
+            walk_element.stop_name = props.stop_from;
+            walk_element.to_stop_name = props.stop_to;
+            walk_element.time = props.travel_time;
+            route_stat.items.push_back(std::move(walk_element));
+
+            total_time += props.travel_time;
+            continue;
+        }
+
+        // edges may be weighted with other settings than the graph was built with
+        const double travel_time =
+                double(props.distance) / routing_settings.bus_velocity + double(routing_settings.bus_wait_time);
 
         Route_Element wait_element;
         wait_element.stop_name = props.stop_from;
@@ -277,13 +544,13 @@ std::optional<Route_Stat> RequestHandler::GetRoute(std::string_view from, std::s
         route_stat.items.push_back(std::move(wait_element));
 
         Route_Element go_element;
-        go_element.time = props.travel_time - routing_settings.bus_wait_time;
+        go_element.time = travel_time - routing_settings.bus_wait_time;
         go_element.type = "Bus"s;
         go_element.bus_name = props.bus->name;
         go_element.span_count = props.span_count;
         route_stat.items.push_back(std::move(go_element));
 
-        total_time += props.travel_time;
+        total_time += travel_time;
     }
 
     route_stat.total_time = total_time;
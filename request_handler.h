@@ -2,34 +2,71 @@
 
 #include "map_renderer.h"
 #include "transport_catalogue.h"
+#include "dijkstra.h"
 #include "transport_router.h"
 
 #include <deque>
 #include <optional>
 #include <set>
 #include <string_view>
+#include <vector>
 
 using Container_stops_points = std::deque<std::pair<svg::Point, std::string_view>>;
 
 class RequestHandler {
 public:
-    RequestHandler(const tc::TransportCatalogue& transport_catalogue, const MapRenderer& renderer, const graph::Router<double>& router, const Transport_router& transport_router);
+    RequestHandler(const tc::TransportCatalogue& transport_catalogue, const MapRenderer& renderer, const graph::RouterBase<double>& router, const Transport_router& transport_router);
 
     Bus_Route_Stat GetBusStat(const std::string_view bus_name) const;
-    BusesToStop GetBusesByStop(const std::string_view stop_name) const;
+    // Names of buses going through the known stop
+    const std::set<std::string_view>& GetBusesByStop(const Stop* stop) const;
     svg::Document RenderMap() const;
 
-    std::optional<Route_Stat> GetRoute(const std::string_view from, const std::string_view to) const;
+    const Routing_settings& GetRoutingSettings() const;
+
+    // Buses of the catalogue are re-read after it was updated
+    void UpdateBuses();
+
+    // Stops are of the catalogue, std::nullopt for unknown (null) ones
+    std::optional<Route_Stat> GetRoute(const Stop* from, const Stop* to) const;
+
+    // Route time without its items. It is taken from hub labels if they are built, otherwise from the router
+    std::optional<double> GetRouteTime(const Stop* from, const Stop* to) const;
+
+    // Routes from one origin to many destinations by a single search of the router, the result is ordered as destinations
+    std::vector<std::optional<Route_Stat>> GetRoutes(const Stop* from, const std::vector<const Stop*>& destinations) const;
+
+    // Route for the routing settings instead of the base ones
+    std::optional<Route_Stat> GetRoute(const Stop* from, const Stop* to, const Routing_settings& routing_settings) const;
+
+    // Earliest arrival route by bus timetables, std::nullopt if there are no timetables
+    std::optional<Route_Stat> GetRoute(const Stop* from, const Stop* to, double departure_time) const;
+
+    // Door-to-door route between arbitrary points. Walking from origin to stops near it and from stops near
+    // destination is included into the single search, so it is not repeated for every pair of stops
+    std::optional<Route_Stat> GetRoute(geo::Coordinates from, geo::Coordinates to) const;
+
+    // Stops reachable from the stop within time budget with their arrival times, sorted by time.
+    // std::nullopt means the stop is unknown
+    std::optional<std::vector<std::pair<std::string_view, double>>> GetReachableStops(const Stop* from,
+                                                                                      double time_budget) const;
+
+    // Travel times matrix by one search per source stop, unknown stops and unreachable pairs are empty
+    std::vector<std::vector<std::optional<double>>> GetTravelTimes(const std::vector<const Stop*>& sources,
+                                                                   const std::vector<const Stop*>& targets) const;
 
 private:
     static int GetUniqueStopsCount(const Bus* bus) ;
     double CalculateGPSLength(const Bus* bus) const;
     int CalculateRealLength(const Bus* bus) const;
+    Route_Stat MakeRouteStat(const graph::RouterBase<double>::RouteInfo& route_info,
+                             const Routing_settings& routing_settings) const;
+    std::vector<std::pair<graph::VertexId, double>> GetWalkingTimesToStops(geo::Coordinates point) const;
 
 private:
     const tc::TransportCatalogue& transport_catalogue_;
     const MapRenderer& renderer_;
-    const graph::Router<double>& router_;
+    const graph::RouterBase<double>& router_;
     const Transport_router& transport_router_;
 
 private:
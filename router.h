@@ -2,7 +2,10 @@
 
 #pragma once
 
+#include "dijkstra.h"
 #include "graph.h"
+#include "router_base.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
@@ -11,25 +14,26 @@
 #include <optional>
 #include <stdexcept>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
     template <typename Weight>
-    class Router {
+    class Router : public RouterBase<Weight> {
     private:
         using Graph = DirectedWeightedGraph<Weight>;
 
     public:
+        using typename RouterBase<Weight>::RouteInfo;
+
         explicit Router(const Graph& graph);
 
-        struct RouteInfo {
-            Weight weight;
-            std::vector<EdgeId> edges;
-        };
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
 
-        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        // Every row of the table is a shortest path tree, so only affected rows are recomputed by Dijkstra
+        size_t Repair(const std::vector<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) override;
 
     private:
         struct RouteInternalData {
@@ -72,8 +76,9 @@ namespace graph {
             }
         }
 
+        // Rows are relaxed by the threads: a row changes only itself and the row of vertex_through never changes
         void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            ThreadPool::GetShared().ParallelFor(0, vertex_count, [this, vertex_count, vertex_through](VertexId vertex_from) {
                 if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
                     for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
                         if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
@@ -81,6 +86,45 @@ namespace graph {
                         }
                     }
                 }
+            });
+        }
+
+        bool IsRowAffected(VertexId vertex_from, const std::unordered_set<EdgeId>& removed_edges,
+                           const std::vector<EdgeId>& added_edges) const {
+            const auto& row = routes_internal_data_[vertex_from];
+
+            for (const auto& route_internal_data : row) {
+                if (route_internal_data && route_internal_data->prev_edge
+                    && removed_edges.count(*route_internal_data->prev_edge) > 0) {
+                    return true;
+                }
+            }
+
+            for (const EdgeId edge_id : added_edges) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const auto& route_from = row[edge.from];
+                const auto& route_to = row[edge.to];
+
+                if (route_from && (!route_to || route_from->weight + edge.weight < route_to->weight)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void RebuildRow(VertexId vertex_from) {
+            const ShortestPathTree<Weight> tree = BuildShortestPathTree(graph_, vertex_from);
+            auto& row = routes_internal_data_[vertex_from];
+
+            for (VertexId vertex_to = 0; vertex_to < row.size(); ++vertex_to) {
+                if (!tree.IsReached(vertex_to)) {
+                    row[vertex_to] = std::nullopt;
+                } else if (tree.prev_edges[vertex_to] == NO_EDGE) {
+                    row[vertex_to] = RouteInternalData{ tree.weights[vertex_to], std::nullopt };
+                } else {
+                    row[vertex_to] = RouteInternalData{ tree.weights[vertex_to], tree.prev_edges[vertex_to] };
+                }
             }
         }
 
@@ -126,4 +170,23 @@ namespace graph {
         return RouteInfo{ weight, std::move(edges) };
     }
 
+    template <typename Weight>
+    size_t Router<Weight>::Repair(const std::vector<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) {
+        const std::unordered_set<EdgeId> removed_edges_set(removed_edges.begin(), removed_edges.end());
+
+        // all rows are checked before any of them is rebuilt
+        std::vector<VertexId> affected_rows;
+        for (VertexId vertex_from = 0; vertex_from < routes_internal_data_.size(); ++vertex_from) {
+            if (IsRowAffected(vertex_from, removed_edges_set, added_edges)) {
+                affected_rows.push_back(vertex_from);
+            }
+        }
+
+        ThreadPool::GetShared().ParallelFor(0, affected_rows.size(), [this, &affected_rows](size_t idx) {
+            RebuildRow(affected_rows[idx]);
+        });
+
+        return affected_rows.size();
+    }
+
 } // namespace graph
\ No newline at end of file
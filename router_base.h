@@ -0,0 +1,41 @@
+#pragma once
+
+#include "graph.h"
+
+#include <optional>
+#include <vector>
+
+namespace graph {
+
+    // Common interface of all routing engines built over DirectedWeightedGraph
+    template <typename Weight>
+    class RouterBase {
+    public:
+        struct RouteInfo {
+            Weight weight;
+            std::vector<EdgeId> edges;
+        };
+
+        virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+        // Routes from one source to many targets, ordered as targets.
+        // Engines searching per source override it to search once for all targets
+        virtual std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+            std::vector<std::optional<RouteInfo>> routes;
+            routes.reserve(targets.size());
+
+            for (VertexId to : targets) {
+                routes.push_back(BuildRoute(from, to));
+            }
+
+            return routes;
+        }
+
+        // Brings routes up to date after the edges were removed from the graph and added to it.
+        // Only sources whose routes may have changed are touched, their count is returned
+        virtual size_t Repair(const std::vector<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) = 0;
+
+        virtual ~RouterBase() = default;
+    };
+
+} // namespace graph
@@ -0,0 +1,105 @@
+#define _USE_MATH_DEFINES
+
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+namespace geo {
+
+    namespace {
+        // length of a latitude degree by the earth radius of ComputeDistance
+        constexpr double METERS_PER_DEGREE = 6371000 * M_PI / 180.0;
+        constexpr double MAX_LATITUDE = 90.0;
+    }
+
+    SpatialGrid::SpatialGrid(const std::vector<Coordinates>& points, double cell_size_meters)
+        : points_(points) {
+
+        if (cell_size_meters <= 0.0) {
+            throw std::invalid_argument("Grid cell size should be positive"s);
+        }
+
+        double max_abs_lat = 0.0;
+        for (const Coordinates& point : points_) {
+            max_abs_lat = std::max(max_abs_lat, std::abs(point.lat));
+        }
+
+        // longitude degrees are shorter far from the equator, cells are wide enough at the farthest point
+        cell_lat_size_ = cell_size_meters / METERS_PER_DEGREE;
+        cell_lng_size_ = cell_lat_size_ / std::max(std::cos(max_abs_lat * M_PI / 180.0), 1e-6);
+
+        for (size_t idx = 0; idx < points_.size(); ++idx) {
+            const int row = GetRow(points_[idx].lat);
+            const int column = GetColumn(points_[idx].lng);
+
+            if (idx == 0) {
+                min_row_ = max_row_ = row;
+                min_column_ = max_column_ = column;
+            } else {
+                min_row_ = std::min(min_row_, row);
+                max_row_ = std::max(max_row_, row);
+                min_column_ = std::min(min_column_, column);
+                max_column_ = std::max(max_column_, column);
+            }
+
+            cells_[GetCellKey(row, column)].push_back(idx);
+        }
+    }
+
+    int SpatialGrid::GetRow(double lat) const {
+        return static_cast<int>(std::floor(lat / cell_lat_size_));
+    }
+
+    int SpatialGrid::GetColumn(double lng) const {
+        return static_cast<int>(std::floor(lng / cell_lng_size_));
+    }
+
+    SpatialGrid::CellKey SpatialGrid::GetCellKey(int row, int column) {
+        return (static_cast<CellKey>(static_cast<uint32_t>(row)) << 32) | static_cast<uint32_t>(column);
+    }
+
+    std::vector<std::pair<size_t, double>> SpatialGrid::FindWithin(Coordinates center, double radius) const {
+        std::vector<std::pair<size_t, double>> found;
+
+        if (points_.empty() || radius < 0.0) {
+            return found;
+        }
+
+        const double lat_delta = radius / METERS_PER_DEGREE;
+        const double band_max_abs_lat = std::min(std::abs(center.lat) + lat_delta, MAX_LATITUDE);
+        const double lng_delta = lat_delta / std::max(std::cos(band_max_abs_lat * M_PI / 180.0), 1e-6);
+
+        // one more cell around as a great circle between points bends to the pole
+        const int first_row = std::max(GetRow(center.lat - lat_delta) - 1, min_row_);
+        const int last_row = std::min(GetRow(center.lat + lat_delta) + 1, max_row_);
+        const int first_column = std::max(GetColumn(center.lng - lng_delta) - 1, min_column_);
+        const int last_column = std::min(GetColumn(center.lng + lng_delta) + 1, max_column_);
+
+        for (int row = first_row; row <= last_row; ++row) {
+            for (int column = first_column; column <= last_column; ++column) {
+                const auto cell_it = cells_.find(GetCellKey(row, column));
+
+                if (cell_it == cells_.end()) {
+                    continue;
+                }
+
+                for (size_t idx : cell_it->second) {
+                    const double distance = ComputeDistance(center, points_[idx]);
+
+                    if (distance <= radius) {
+                        found.emplace_back(idx, distance);
+                    }
+                }
+            }
+        }
+
+        std::sort(found.begin(), found.end());
+
+        return found;
+    }
+
+} // namespace geo
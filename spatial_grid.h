@@ -0,0 +1,41 @@
+#pragma once
+
+#include "geo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace geo {
+
+    // Uniform grid of points for radius queries: only points of the cells overlapping the circle are checked
+    class SpatialGrid {
+    public:
+        SpatialGrid(const std::vector<Coordinates>& points, double cell_size_meters);
+
+        // Indexes of the points within the radius in meters with distances to them, sorted by index
+        std::vector<std::pair<size_t, double>> FindWithin(Coordinates center, double radius) const;
+
+    private:
+        using CellKey = uint64_t;
+
+        int GetRow(double lat) const;
+        int GetColumn(double lng) const;
+        static CellKey GetCellKey(int row, int column);
+
+    private:
+        std::vector<Coordinates> points_;
+        double cell_lat_size_{}; // in degrees
+        double cell_lng_size_{};
+
+        int min_row_{};
+        int max_row_{};
+        int min_column_{};
+        int max_column_{};
+
+        std::unordered_map<CellKey, std::vector<size_t>> cells_;
+    };
+
+} // namespace geo
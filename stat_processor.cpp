@@ -0,0 +1,234 @@
+#include "stat_processor.h"
+#include "json_reader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <sstream>
+#include <thread>
+
+using namespace std::literals;
+
+namespace {
+
+    // Fills the graph with the catalogue and prepares the routing engine of the settings.
+    // Overlay and timetable routers are built by the first request which needs them
+    std::unique_ptr<graph::RouterBase<double>> BuildRouter(Transport_router& transport_router,
+                                                           const Routing_settings& routing_settings) {
+        transport_router.CreateGraph();
+
+        if (!routing_settings.hub_labels_file.empty()) {
+            transport_router.CreateHubLabels();
+        }
+
+        return transport_router.CreateRouter();
+    }
+
+    const std::optional<Route_Stat>* FindBatchRoute(const std::unordered_map<size_t, std::optional<Route_Stat>>& batch_routes,
+                                                   size_t position) {
+        const auto it = batch_routes.find(position);
+
+        return it == batch_routes.end() ? nullptr : &it->second;
+    }
+
+} // namespace
+
+StatProcessor::StatProcessor(tc::TransportCatalogue& catalogue, Routing_settings routing_settings,
+                             RenderSettings render_settings)
+    : catalogue_(catalogue)
+    , routing_settings_(std::move(routing_settings))
+    , routes_graph_(catalogue.GetAllStopsCount())
+    , transport_router_(routes_graph_, catalogue, routing_settings_)
+    , router_(BuildRouter(transport_router_, routing_settings_))
+    , map_renderer_(std::move(render_settings))
+    , request_handler_(catalogue, map_renderer_, *router_, transport_router_) {
+}
+
+void StatProcessor::AnswerBatch(const std::deque<Stat>& queries, json::Writer& writer, size_t threads_count) {
+    // an update changes the base for all later requests
+    for (size_t begin = 0; begin < queries.size();) {
+        size_t end = begin;
+        while (end < queries.size() && !std::holds_alternative<Update_Request>(queries[end])) {
+            ++end;
+        }
+
+        // All-pairs and mapped routers answer by table lookup, the lazy one searches per query,
+        // so "Route" requests between updates are grouped to search once per origin stop
+        Batch_Routes batch_routes;
+
+        if (routing_settings_.router_mode == RouterMode::LAZY) {
+            batch_routes = GetRoutesBatch(queries, begin, end, request_handler_);
+        }
+
+        if (threads_count <= 1) {
+            for (size_t i = begin; i < end; ++i) {
+                Answer(queries[i], FindBatchRoute(batch_routes, i), writer);
+            }
+        } else {
+            AnswerConcurrently(queries, begin, end, batch_routes, writer, threads_count);
+        }
+
+        if (end < queries.size()) {
+            Answer(queries[end], nullptr, writer);
+        }
+
+        begin = end + 1;
+    }
+}
+
+void StatProcessor::AnswerConcurrently(const std::deque<Stat>& queries, size_t begin, size_t end,
+                                       const Batch_Routes& batch_routes, json::Writer& writer, size_t threads_count) {
+    struct Answer_Text {
+        bool is_ready = false;
+        std::string text;
+        std::exception_ptr error;
+    };
+
+    std::vector<Answer_Text> answers(end - begin);
+    std::mutex answers_mutex;
+    std::condition_variable answer_ready;
+
+    // threads take requests in order, so a long one doesn't hold the following ones
+    std::atomic<size_t> next_request = begin;
+
+    auto answer_requests = [&] {
+        for (size_t i = next_request++; i < end; i = next_request++) {
+            Answer_Text answer;
+
+            try {
+                std::ostringstream answer_stream;
+                json::Writer answer_writer(answer_stream, writer.GetOptions(), 1);
+
+                Answer(queries[i], FindBatchRoute(batch_routes, i), answer_writer);
+                answer.text = answer_stream.str();
+            } catch (...) {
+                answer.error = std::current_exception();
+            }
+
+            answer.is_ready = true;
+
+            {
+                std::lock_guard guard(answers_mutex);
+                answers[i - begin] = std::move(answer);
+            }
+            answer_ready.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::min(threads_count, end - begin); ++i) {
+        threads.emplace_back(answer_requests);
+    }
+
+    std::exception_ptr error;
+
+    for (size_t i = begin; i < end; ++i) {
+        Answer_Text answer;
+
+        {
+            std::unique_lock lock(answers_mutex);
+            answer_ready.wait(lock, [&answers, idx = i - begin] {
+                return answers[idx].is_ready;
+            });
+            answer = std::move(answers[i - begin]);
+        }
+
+        if (answer.error) {
+            error = answer.error;
+            next_request = end; // the rest is not started
+            break;
+        }
+
+        writer.RawValue(answer.text).Flush();
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void StatProcessor::Answer(const Stat& request, json::Writer& writer) {
+    Answer(request, nullptr, writer);
+}
+
+void StatProcessor::Answer(const Stat& request, const std::optional<Route_Stat>* batch_route, json::Writer& writer) {
+    if (batch_route == nullptr) {
+        std::visit([this, &writer](const auto& typed_request) {
+            AnswerRequest(typed_request, writer);
+        }, request);
+    } else if (*batch_route == std::nullopt) {
+        Write_Error_Message_Dict(writer, std::get<Route_Request>(request).id, "not found"sv);
+    } else {
+        Write_Route_Dict(writer, std::get<Route_Request>(request).id, batch_route->value());
+    }
+
+    // answers go out as soon as they are ready
+    writer.Flush();
+}
+
+void StatProcessor::PrintRouterStats(std::ostream& output) const {
+    const auto* lazy_router = dynamic_cast<const graph::LazyRouter<double>*>(router_.get());
+
+    if (lazy_router == nullptr) {
+        return;
+    }
+
+    output << "Lazy router cache: "sv << lazy_router->GetCacheHits() << " hits, "sv << lazy_router->GetCacheMisses()
+           << " misses, capacity "sv << lazy_router->GetCacheCapacity() << " trees"sv << std::endl;
+}
+
+void StatProcessor::AnswerRequest(const Bus_Request& request, json::Writer& writer) {
+    WriteBusInfo(request, request_handler_, writer);
+}
+
+void StatProcessor::AnswerRequest(const Stop_Request& request, json::Writer& writer) {
+    WriteBusesList(request, request_handler_, writer);
+}
+
+void StatProcessor::AnswerRequest(const Map_Request& request, json::Writer& writer) {
+    Write_TransportMap_Dict(writer, request.id, GetMap());
+}
+
+void StatProcessor::AnswerRequest(const Route_Request& request, json::Writer& writer) {
+    WriteRoute(request, request_handler_, writer);
+}
+
+void StatProcessor::AnswerRequest(const Coordinates_Route_Request& request, json::Writer& writer) {
+    WriteRoute(request, request_handler_, writer);
+}
+
+void StatProcessor::AnswerRequest(const Matrix_Request& request, json::Writer& writer) {
+    writer.Value(GetTravelTimesNode(request, request_handler_));
+}
+
+void StatProcessor::AnswerRequest(const Isochrone_Request& request, json::Writer& writer) {
+    writer.Value(GetReachableStopsNode(request, request_handler_));
+}
+
+void StatProcessor::AnswerRequest(const Update_Request& request, json::Writer& writer) {
+    auto update_stat = transport_router_.ApplyUpdate(*router_, request.update);
+    request_handler_.UpdateBuses();
+    map_.reset();
+
+    if (update_stat == std::nullopt) {
+        writer.Value(Generate_Error_Message_Dict(request.id, "not found"sv));
+    } else {
+        writer.Value(Generate_Update_Dict(request.id, update_stat.value()));
+    }
+}
+
+const std::string& StatProcessor::GetMap() {
+    std::lock_guard guard(map_mutex_);
+
+    if (!map_) {
+        std::ostringstream map_stream;
+        request_handler_.RenderMap().Render(map_stream);
+        map_ = map_stream.str();
+    }
+
+    return *map_;
+}
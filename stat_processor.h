@@ -0,0 +1,75 @@
+#pragma once
+
+#include "graph.h"
+#include "json.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+// Routing engine of the filled catalogue with everything needed to answer stat requests.
+// Answers are written to the writer as array items in the order of requests.
+// The catalogue and the routers are read-only between updates, so requests between them may be answered concurrently
+class StatProcessor {
+public:
+    StatProcessor(tc::TransportCatalogue& catalogue, Routing_settings routing_settings, RenderSettings render_settings);
+
+    StatProcessor(const StatProcessor&) = delete;
+    StatProcessor& operator=(const StatProcessor&) = delete;
+
+    // The lazy router answers "Route" requests between updates by the base settings with one cached tree per origin stop,
+    // origins are searched in parallel.
+    // With several threads every answer is printed into its own buffer, buffers are written in the order
+    // of requests as soon as preceding ones are written. Updates wait for all preceding answers
+    void AnswerBatch(const std::deque<Stat>& queries, json::Writer& writer, size_t threads_count = 1);
+
+    // One request as soon as it is read
+    void Answer(const Stat& request, json::Writer& writer);
+
+    // A line with cache hits, misses and capacity of the lazy router, nothing for other router modes
+    void PrintRouterStats(std::ostream& output) const;
+
+private:
+    using Batch_Routes = std::unordered_map<size_t, std::optional<Route_Stat>>;
+
+    // The route is found beforehand by a batch search
+    void Answer(const Stat& request, const std::optional<Route_Stat>* batch_route, json::Writer& writer);
+
+    // Requests of the range without updates
+    void AnswerConcurrently(const std::deque<Stat>& queries, size_t begin, size_t end, const Batch_Routes& batch_routes,
+                            json::Writer& writer, size_t threads_count);
+
+    // The map is rendered once until the next update
+    const std::string& GetMap();
+
+    void AnswerRequest(const Bus_Request& request, json::Writer& writer);
+    void AnswerRequest(const Stop_Request& request, json::Writer& writer);
+    void AnswerRequest(const Map_Request& request, json::Writer& writer);
+    void AnswerRequest(const Route_Request& request, json::Writer& writer);
+    void AnswerRequest(const Coordinates_Route_Request& request, json::Writer& writer);
+    void AnswerRequest(const Matrix_Request& request, json::Writer& writer);
+    void AnswerRequest(const Isochrone_Request& request, json::Writer& writer);
+    void AnswerRequest(const Update_Request& request, json::Writer& writer);
+
+private:
+    tc::TransportCatalogue& catalogue_;
+    Routing_settings routing_settings_;
+
+    graph::DirectedWeightedGraph<double> routes_graph_; // one vertex per one Stop
+    Transport_router transport_router_;
+    std::unique_ptr<graph::RouterBase<double>> router_;
+
+    MapRenderer map_renderer_;
+    RequestHandler request_handler_;
+
+    std::mutex map_mutex_;
+    std::optional<std::string> map_;
+};
@@ -0,0 +1,319 @@
+#include "stat_server.h"
+#include "json_reader.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std::literals;
+
+namespace {
+
+    // Closes the socket when it is done
+    class SocketDescriptor {
+    public:
+        explicit SocketDescriptor(int fd)
+            : fd_(fd) {
+        }
+
+        SocketDescriptor(const SocketDescriptor&) = delete;
+        SocketDescriptor& operator=(const SocketDescriptor&) = delete;
+
+        ~SocketDescriptor() {
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+        }
+
+        int Get() const {
+            return fd_;
+        }
+
+    private:
+        int fd_;
+    };
+
+    [[noreturn]] void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    bool IsPort(const std::string& address) {
+        return !address.empty() && address.size() <= 5
+               && address.find_first_not_of("0123456789"sv) == std::string::npos;
+    }
+
+    int ListenTcp(const std::string& port) {
+        const int port_number = std::stoi(port);
+        if (port_number > UINT16_MAX) {
+            throw std::system_error(std::make_error_code(std::errc::invalid_argument), "Can't bind localhost port "s + port);
+        }
+
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            ThrowSystemError("Can't create a socket"s);
+        }
+
+        const int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        // only local clients are served
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(port_number));
+
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            const int error = errno;
+            close(fd);
+            errno = error;
+            ThrowSystemError("Can't bind localhost port "s + port);
+        }
+
+        return fd;
+    }
+
+    int ListenUnix(const std::string& path) {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::system_error(std::make_error_code(std::errc::filename_too_long), "Can't bind socket "s + path);
+        }
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            ThrowSystemError("Can't create a socket"s);
+        }
+
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        // a socket file left by a previous run is replaced, other files are kept and fail the bind
+        struct stat file_stat{};
+        if (lstat(path.c_str(), &file_stat) == 0 && S_ISSOCK(file_stat.st_mode)) {
+            unlink(path.c_str());
+        }
+
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            const int error = errno;
+            close(fd);
+            errno = error;
+            ThrowSystemError("Can't bind socket "s + path);
+        }
+
+        return fd;
+    }
+
+    bool SendAll(int fd, std::string_view data) {
+        while (!data.empty()) {
+            // a closed connection gives an error instead of SIGPIPE
+            const ssize_t sent = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+
+            data.remove_prefix(static_cast<size_t>(sent));
+        }
+
+        return true;
+    }
+
+    std::optional<int> FindRequestId(const json::Node& root) {
+        if (!root.IsDict()) {
+            return std::nullopt;
+        }
+
+        const auto id_it = root.AsDict().find("id"sv);
+        if (id_it == root.AsDict().end() || !id_it->second.IsInt()) {
+            return std::nullopt;
+        }
+
+        return id_it->second.AsInt();
+    }
+
+    bool IsUpdate(const json::Node& root) {
+        if (!root.IsDict()) {
+            return false;
+        }
+
+        const auto type_it = root.AsDict().find("type"sv);
+
+        return type_it != root.AsDict().end() && type_it->second.IsString() && type_it->second.AsString() == "Update"s;
+    }
+
+} // namespace
+
+StatServer::StatServer(const tc::TransportCatalogue& catalogue, StatProcessor& processor,
+                       json::PrintOptions print_options)
+    : catalogue_(catalogue)
+    , processor_(processor)
+    , print_options_(print_options) {
+    // an answer is exactly one line
+    print_options_.compact = true;
+}
+
+void StatServer::Serve(const std::string& address) {
+    const SocketDescriptor listen_socket(IsPort(address) ? ListenTcp(address) : ListenUnix(address));
+
+    if (listen(listen_socket.Get(), SOMAXCONN) < 0) {
+        ThrowSystemError("Can't listen on "s + address);
+    }
+
+    while (true) {
+        WaitFreeConnection();
+
+        const int connection_fd = accept(listen_socket.Get(), nullptr, nullptr);
+
+        if (connection_fd < 0) {
+            const int error = errno;
+            ReleaseConnection();
+
+            // the client may be gone before it is accepted
+            if (error == EINTR || error == ECONNABORTED) {
+                continue;
+            }
+            errno = error;
+            ThrowSystemError("Can't accept a connection on "s + address);
+        }
+
+        std::thread([this, connection_fd] {
+            ServeConnection(connection_fd);
+            ReleaseConnection();
+        }).detach();
+    }
+}
+
+void StatServer::WaitFreeConnection() {
+    std::unique_lock lock(connections_mutex_);
+    connection_released_.wait(lock, [this] {
+        return connections_count_ < MAX_CONNECTIONS;
+    });
+
+    ++connections_count_;
+}
+
+void StatServer::ReleaseConnection() {
+    {
+        std::lock_guard guard(connections_mutex_);
+        --connections_count_;
+    }
+    connection_released_.notify_one();
+}
+
+void StatServer::ServeConnection(int connection_fd) {
+    const SocketDescriptor connection(connection_fd);
+
+    std::string input;
+    char chunk[64 * 1024];
+
+    // lines are answered in order, a partial line waits for the rest
+    while (true) {
+        const ssize_t received = recv(connection.Get(), chunk, sizeof(chunk), 0);
+
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return;
+        }
+
+        input.append(chunk, static_cast<size_t>(received));
+
+        std::string answers;
+        size_t line_begin = 0;
+
+        for (size_t line_end = input.find('\n'); line_end != std::string::npos;
+             line_begin = line_end + 1, line_end = input.find('\n', line_begin)) {
+            std::string_view line(input.data() + line_begin, line_end - line_begin);
+
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+
+            if (line.find_first_not_of(" \t"sv) == std::string_view::npos) {
+                continue;
+            }
+
+            answers += AnswerLine(line);
+            answers += '\n';
+        }
+
+        input.erase(0, line_begin);
+
+        // the rest of a too long line is not read
+        if (input.size() > MAX_LINE_SIZE) {
+            answers += R"({"error_message":"request line is too long"})"sv;
+            answers += '\n';
+            SendAll(connection.Get(), answers);
+            return;
+        }
+
+        if (!SendAll(connection.Get(), answers)) {
+            return;
+        }
+    }
+}
+
+std::string StatServer::AnswerLine(std::string_view line) {
+    std::ostringstream answer_stream;
+    json::Writer writer(answer_stream, print_options_);
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::optional<int> id;
+
+    try {
+        const json::Document document = LoadJSON(line, &arena);
+        id = FindRequestId(document.GetRoot());
+
+        // the request is parsed under the lock too, since it refers to stops of the catalogue
+        std::shared_lock<std::shared_mutex> shared_lock(base_mutex_, std::defer_lock);
+        std::unique_lock<std::shared_mutex> unique_lock(base_mutex_, std::defer_lock);
+
+        if (IsUpdate(document.GetRoot())) {
+            unique_lock.lock();
+        } else {
+            shared_lock.lock();
+        }
+
+        const std::optional<Stat> request = ParseStatRequest(document.GetRoot().AsDict(), catalogue_);
+
+        if (!request) {
+            Write_Error_Message_Dict(writer, *id, "unknown request type"sv);
+        } else {
+            processor_.Answer(*request, writer);
+        }
+    } catch (const std::exception& error) {
+        // a part of the failed answer may be in the stream already, so it is started anew
+        answer_stream.str({});
+        json::Writer error_writer(answer_stream, print_options_);
+
+        if (id) {
+            Write_Error_Message_Dict(error_writer, *id, error.what());
+        } else {
+            error_writer.StartDict().Key("error_message"sv).Value(error.what()).EndDict();
+        }
+        error_writer.Flush();
+
+        return answer_stream.str();
+    }
+
+    writer.Flush();
+
+    return answer_stream.str();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "json.h"
+#include "stat_processor.h"
+#include "transport_catalogue.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+/*
+Serves stat requests of local clients once the base is loaded. A client sends one JSON request per line
+and gets one compact JSON answer per line in the same order. Every connection has its own thread,
+requests of different connections are answered concurrently, "Update" requests are applied alone
+*/
+class StatServer {
+public:
+    // Further clients wait in the backlog of the socket until a connection is closed
+    static constexpr size_t MAX_CONNECTIONS = 256;
+    // A longer line gets an error and the connection is closed
+    static constexpr size_t MAX_LINE_SIZE = 1024 * 1024;
+
+    StatServer(const tc::TransportCatalogue& catalogue, StatProcessor& processor, json::PrintOptions print_options);
+
+    StatServer(const StatServer&) = delete;
+    StatServer& operator=(const StatServer&) = delete;
+
+    // A number is a localhost TCP port, anything else is a path of a Unix domain socket.
+    // Accepts connections until an error, throws std::system_error on it.
+    // An existing socket file of the path is replaced, any other file is an error
+    [[noreturn]] void Serve(const std::string& address);
+
+    // The answer to a line of a client without a line break. A malformed or unknown request
+    // gets {"error_message": ...} with "request_id" if the request has a valid one
+    std::string AnswerLine(std::string_view line);
+
+private:
+    void ServeConnection(int connection_fd);
+
+    void WaitFreeConnection();
+    void ReleaseConnection();
+
+private:
+    const tc::TransportCatalogue& catalogue_;
+    StatProcessor& processor_;
+    json::PrintOptions print_options_;
+
+    // requests read the catalogue and the routers together, updates change them
+    std::shared_mutex base_mutex_;
+
+    std::mutex connections_mutex_;
+    std::condition_variable connection_released_;
+    size_t connections_count_ = 0;
+};
@@ -1,4 +1,5 @@
 #include "svg.h"
+#include "char_set.h"
 
 namespace svg {
 
@@ -177,35 +178,40 @@ namespace svg {
     }
 
     std::string Text::SpecialSymbolsShield(const std::string& str) {
+        static const CharSet special_chars("\"'`<>&"sv);
+
         std::string out_str;
+        out_str.reserve(str.size());
 
-        for (char current_char : str) {
-            if (current_char == '"') {
-                out_str += "&quot;"sv;
-                continue;
-            }
+        // runs without special chars are copied as a whole
+        for (size_t pos = 0; pos < str.size();) {
+            const size_t special_pos = special_chars.FindIn(str, pos);
+            out_str.append(str, pos, special_pos - pos);
 
-            if (current_char == '\'' || current_char == '`') {
-                out_str += "&apos;"sv;
-                continue;
+            if (special_pos == str.size()) {
+                break;
             }
 
-            if (current_char == '<') {
+            switch (str[special_pos]) {
+            case '"':
+                out_str += "&quot;"sv;
+                break;
+            case '\'':
+            case '`':
+                out_str += "&apos;"sv;
+                break;
+            case '<':
                 out_str += "&lt;"sv;
-                continue;
-            }
-
-            if (current_char == '>') {
+                break;
+            case '>':
                 out_str += "&gt;"sv;
-                continue;
-            }
-
-            if (current_char == '&') {
+                break;
+            default:
                 out_str += "&amp;"sv;
-                continue;
+                break;
             }
 
-            out_str += current_char;
+            pos = special_pos + 1;
         }
 
         return out_str;
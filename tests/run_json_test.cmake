@@ -0,0 +1,15 @@
+# Runs the program on INPUT with ARGS and compares its output with EXPECTED
+execute_process(COMMAND ${PROGRAM} ${ARGS} --compact-output --input ${INPUT}
+                OUTPUT_VARIABLE output
+                ERROR_VARIABLE error
+                RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${PROGRAM} failed with ${result}: ${error}")
+endif()
+
+file(READ ${EXPECTED} expected)
+
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR "Unexpected output:\n${output}\nExpected:\n${expected}")
+endif()
@@ -0,0 +1,196 @@
+#include "thread_pool.h"
+
+#include <stdexcept>
+
+using namespace std::literals;
+
+namespace {
+
+    // Queue of the current worker thread, none for other threads
+    thread_local const ThreadPool* current_pool = nullptr;
+    thread_local size_t current_worker_idx = 0;
+
+    size_t shared_threads_count = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads_count) {
+    if (threads_count == 0) {
+        throw std::invalid_argument("A pool needs at least one thread"s);
+    }
+
+    const size_t workers_count = threads_count - 1;
+
+    for (size_t i = 0; i < workers_count; ++i) {
+        queues_.push_back(std::make_unique<Worker_Queue>());
+    }
+
+    for (size_t i = 0; i < workers_count; ++i) {
+        workers_.emplace_back([this, i] {
+            RunWorker(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard guard(wake_mutex_);
+        is_stopped_ = true;
+    }
+    wake_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::GetThreadsCount() const {
+    return workers_.size() + 1;
+}
+
+ThreadPool& ThreadPool::GetShared() {
+    static ThreadPool pool(shared_threads_count > 0 ? shared_threads_count
+                                                    : std::max<size_t>(std::thread::hardware_concurrency(), 1));
+
+    return pool;
+}
+
+void ThreadPool::SetSharedThreadsCount(size_t threads_count) {
+    shared_threads_count = threads_count;
+}
+
+void ThreadPool::Push(Task task) {
+    // a worker forks into its own queue, others spread their tasks
+    const size_t queue_idx = current_pool == this ? current_worker_idx : next_queue_++ % queues_.size();
+
+    {
+        std::lock_guard guard(queues_[queue_idx]->mutex);
+        queues_[queue_idx]->tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard guard(wake_mutex_);
+        ++queued_count_;
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::TryRunTask() {
+    const size_t queues_count = queues_.size();
+    const bool is_worker = current_pool == this;
+    const size_t first_idx = is_worker ? current_worker_idx : 0;
+
+    Task task;
+
+    for (size_t shift = 0; shift < queues_count && !task; ++shift) {
+        Worker_Queue& queue = *queues_[(first_idx + shift) % queues_count];
+        std::lock_guard guard(queue.mutex);
+
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        // the own newest task is hot in cache, the oldest task of another queue is likely the largest
+        if (is_worker && shift == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task) {
+        return false;
+    }
+
+    --queued_count_;
+    task();
+
+    return true;
+}
+
+void ThreadPool::RunWorker(size_t worker_idx) {
+    current_pool = this;
+    current_worker_idx = worker_idx;
+
+    while (true) {
+        if (TryRunTask()) {
+            continue;
+        }
+
+        std::unique_lock lock(wake_mutex_);
+        wake_.wait(lock, [this] {
+            return is_stopped_ || queued_count_ > 0;
+        });
+
+        if (is_stopped_) {
+            return;
+        }
+    }
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : pool_(pool) {
+}
+
+TaskGroup::~TaskGroup() {
+    // the error is lost if it was not waited for
+    try {
+        Wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::Run(ThreadPool::Task task) {
+    auto guarded_task = [this, &pool = pool_, task = std::move(task)] {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard guard(error_mutex_);
+
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+
+        // the group may be gone as soon as its last task is done, so only the pool is used after it
+        if (--pending_count_ == 0) {
+            {
+                std::lock_guard guard(pool.wake_mutex_);
+            }
+            pool.wake_.notify_all();
+        }
+    };
+
+    ++pending_count_;
+
+    if (pool_.queues_.empty()) {
+        guarded_task();
+    } else {
+        pool_.Push(std::move(guarded_task));
+    }
+}
+
+void TaskGroup::Wait() {
+    while (pending_count_ > 0) {
+        // the rest of the tasks are taken from the queues
+        if (pool_.TryRunTask()) {
+            continue;
+        }
+
+        // tasks of the group are running in other threads, sleep until they are done or new tasks are queued
+        std::unique_lock lock(pool_.wake_mutex_);
+        pool_.wake_.wait(lock, [this] {
+            return pending_count_ == 0 || pool_.queued_count_ > 0;
+        });
+    }
+
+    std::lock_guard guard(error_mutex_);
+
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
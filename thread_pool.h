@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Work-stealing pool. Every worker has its own queue: it runs its newest task first and,
+when the queue is empty, steals the oldest task of another worker. A thread waiting for its tasks
+runs queued tasks meanwhile and sleeps when there are none, so tasks may fork and join nested tasks
+without blocking the pool.
+A pool of one thread has no workers, tasks run at once in the calling thread
+*/
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // The calling thread counts as one of the threads
+    explicit ThreadPool(size_t threads_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadsCount() const;
+
+    // Pool of the build phases. Its size is set before the first use, hardware concurrency by default
+    static ThreadPool& GetShared();
+    static void SetSharedThreadsCount(size_t threads_count);
+
+    // Calls the function for every index of the range, contiguous chunks of indexes are tasks
+    template <typename Function>
+    void ParallelFor(size_t begin, size_t end, Function function);
+
+private:
+    friend class TaskGroup;
+
+    struct Worker_Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void Push(Task task);
+
+    // Runs one queued task if there is any, the own queue is tried first
+    bool TryRunTask();
+
+    void RunWorker(size_t worker_idx);
+
+private:
+    std::vector<std::unique_ptr<Worker_Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_count_ = 0;
+    std::atomic<size_t> next_queue_ = 0; // tasks of outer threads are spread over queues
+    bool is_stopped_ = false;
+};
+
+// Fork/join of tasks. Wait runs queued tasks until all tasks of the group are done, sleeping while the last ones
+// run in other threads, and rethrows the first exception of them. The destructor waits too
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::GetShared());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void Run(ThreadPool::Task task);
+    void Wait();
+
+private:
+    ThreadPool& pool_;
+    std::atomic<size_t> pending_count_ = 0;
+
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+template <typename Function>
+void ThreadPool::ParallelFor(size_t begin, size_t end, Function function) {
+    if (begin >= end) {
+        return;
+    }
+
+    // several chunks per thread even out uneven items
+    constexpr size_t CHUNKS_PER_THREAD = 4;
+    const size_t chunks_count = std::min(end - begin, GetThreadsCount() * CHUNKS_PER_THREAD);
+    const size_t chunk_size = (end - begin + chunks_count - 1) / chunks_count;
+
+    TaskGroup group(*this);
+
+    for (size_t first = begin; first < end; first += chunk_size) {
+        const size_t last = std::min(first + chunk_size, end);
+
+        group.Run([&function, first, last] {
+            for (size_t idx = first; idx < last; ++idx) {
+                function(idx);
+            }
+        });
+    }
+
+    group.Wait();
+}
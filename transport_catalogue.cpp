@@ -1,4 +1,5 @@
 #include "transport_catalogue.h"
+#include "thread_pool.h"
 
 using namespace std;
 
@@ -15,6 +16,11 @@ namespace tc {
         return stop_to_idx_.at(stop);
     }
 
+    const Stop* TransportCatalogue::GetStopByIndex(size_t idx) const {
+        // stops indexes follow the order of adding to base
+        return &stops_.at(idx);
+    }
+
     void TransportCatalogue::AddStopDistancesToBase(const Stop& stop) {
         const Stop* stop_from = GetStopByName(stop.name);
 
@@ -35,15 +41,48 @@ namespace tc {
         }
     }
 
+    bool TransportCatalogue::RemoveRouteFromBase(std::string_view bus_name) {
+        const Bus* bus = GetRouteByBusName(bus_name);
+
+        if (bus == nullptr) {
+            return false;
+        }
+
+        // names are views of the bus name, so they are erased before the bus
+        for (const auto& stop_name : bus->stops) {
+            const Stop* stop = GetStopByName(stop_name);
+            stop_to_buses_[stop].erase(bus->name);
+        }
+
+        names_to_buses_.erase(bus->name);
+        buses_.remove_if([bus](const Bus& item) { return &item == bus; });
+
+        return true;
+    }
+
+    void TransportCatalogue::SetStopsDistance(const Stop* stop_from, const Stop* stop_to, int distance) {
+        StopsDistance_to_length_[std::make_pair(stop_from, stop_to)] = distance;
+    }
+
     void TransportCatalogue::FillTransportBase(const std::deque<Stop>& stops, const std::deque<Bus>& buses) {
         // fill all stops to base
         for (auto& stop : stops) {
             AddStopToBase(stop);
         }
 
-        // fill all distances
-        for (auto& stop : stops) {
-            AddStopDistancesToBase(stop);
+        // fill all distances, names are resolved by the threads and the pairs are put in order
+        std::vector<std::vector<std::pair<std::pair<const Stop*, const Stop*>, int>>> stops_distances(stops.size());
+
+        ThreadPool::GetShared().ParallelFor(0, stops.size(), [this, &stops, &stops_distances](size_t idx) {
+            const Stop* stop_from = GetStopByName(stops[idx].name);
+
+            for (const auto& [distance, stop_to_name] : stops[idx].distances_to_stops) {
+                stops_distances[idx].push_back({ { stop_from, GetStopByName(stop_to_name) }, distance });
+            }
+        });
+
+        for (const auto& stop_distances : stops_distances) {
+            StopsDistance_to_length_.insert(stop_distances.begin(), stop_distances.end());
         }
 
         // fill all routes
@@ -104,7 +143,7 @@ namespace tc {
         return stops_;
     }
 
-    const std::deque<Bus>& TransportCatalogue::GetAllBuses() const {
+    const std::list<Bus>& TransportCatalogue::GetAllBuses() const {
         return buses_;
     }
 
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <deque>
+#include <list>
 #include <numeric>
 #include <optional>
 #include <set>
@@ -29,21 +30,26 @@ namespace tc {
         void AddStopDistancesToBase(const Stop& stop);
         void FillTransportBase(const std::deque<Stop>& stops, const std::deque<Bus>& buses);
 
+        // Live changes, pointers to other buses and stops stay valid
+        bool RemoveRouteFromBase(std::string_view bus_name);
+        void SetStopsDistance(const Stop* stop_from, const Stop* stop_to, int distance);
+
         const Bus* GetRouteByBusName(std::string_view bus_name) const;
         const Stop* GetStopByName(std::string_view stop_name) const;
         const std::set<std::string_view>& GetBusesToStop(const Stop* stop) const;
         std::optional<int> GetDistanceByStopsPair(const Stop* stop_from, const Stop* stop_to) const;
 
         const std::deque<Stop>& GetAllStops() const;
-        const std::deque<Bus>& GetAllBuses() const;
+        const std::list<Bus>& GetAllBuses() const;
 
         size_t GetAllStopsCount() const;
         size_t GetStopIndex(const Stop* stop) const;
+        const Stop* GetStopByIndex(size_t idx) const;
 
     private:
         std::unordered_map<const Stop*, size_t> stop_to_idx_;
         std::deque<Stop> stops_;
-        std::deque<Bus> buses_;
+        std::list<Bus> buses_; // buses may be removed by updates
 
         std::unordered_map<std::string_view, const Stop*> names_to_stops_;
         std::unordered_map<std::string_view, const Bus*> names_to_buses_;
@@ -1,103 +1,508 @@
 #include "transport_router.h"
+#include "thread_pool.h"
+
+#include <cmath>
+#include <fstream>
+#include <unordered_set>
 
 using namespace std;
 
 void Transport_router::CreateGraph() {
+    std::vector<geo::Coordinates> stops_coordinates;
+    stops_coordinates.reserve(transport_catalogue_.GetAllStopsCount());
+
+    // vertexes are indexed by stops
+    for (size_t idx = 0; idx < transport_catalogue_.GetAllStopsCount(); ++idx) {
+        const Stop* stop = transport_catalogue_.GetStopByIndex(idx);
+        stops_coordinates.push_back({ stop->latitude, stop->longitude });
+    }
+
+    // any cell size is correct, cells of the query radius size make queries cheap
+    const double grid_cell_size = routing_settings_.walking_transfer_radius > 0.0
+                                          ? routing_settings_.walking_transfer_radius
+                                          : routing_settings_.stop_search_radius;
+    stops_grid_ = std::make_unique<geo::SpatialGrid>(stops_coordinates, std::max(grid_cell_size, 1.0));
+
+    // edges of buses are made by the threads and added to the graph in the order of buses
+    std::vector<const Bus*> buses;
+    for (const Bus& bus : transport_catalogue_.GetAllBuses()) {
+        buses.push_back(&bus);
+    }
+
+    std::vector<Bus_Edges> buses_edges(buses.size());
+    ThreadPool::GetShared().ParallelFor(0, buses.size(), [this, &buses, &buses_edges](size_t idx) {
+        buses_edges[idx] = MakeBusEdges(*buses[idx]);
+    });
+
+    for (size_t idx = 0; idx < buses.size(); ++idx) {
+        AddBusEdges(*buses[idx], std::move(buses_edges[idx]));
+    }
+
+    if (routing_settings_.walking_transfer_radius > 0.0) {
+        AddWalkingEdges();
+    }
+}
+
+void Transport_router::AddWalkingEdges() {
+    const size_t stops_count = transport_catalogue_.GetAllStopsCount();
+
+    // neighbours are searched by the threads
+    std::vector<decltype(stops_grid_->FindWithin({}, 0.0))> stops_near_stops(stops_count);
+    ThreadPool::GetShared().ParallelFor(0, stops_count, [this, &stops_near_stops](size_t idx) {
+        const Stop* stop = transport_catalogue_.GetStopByIndex(idx);
+        stops_near_stops[idx] = stops_grid_->FindWithin({ stop->latitude, stop->longitude },
+                                                        routing_settings_.walking_transfer_radius);
+    });
+
+    for (graph::VertexId idx_stop_from = 0; idx_stop_from < stops_count; ++idx_stop_from) {
+        const Stop* stop_from = transport_catalogue_.GetStopByIndex(idx_stop_from);
+
+        for (const auto& [idx_stop_to, distance] : stops_near_stops[idx_stop_from]) {
+            if (idx_stop_to == idx_stop_from) {
+                continue;
+            }
+
+            // walking time does not depend on bus settings
+            const double walking_time = distance / routing_settings_.walking_velocity;
+
+            Edge_props edge_prop;
+            edge_prop.bus = nullptr;
+            edge_prop.distance = static_cast<int>(std::lround(distance));
+            edge_prop.travel_time = walking_time;
+            edge_prop.stop_from = stop_from->name;
+            edge_prop.stop_to = transport_catalogue_.GetStopByIndex(idx_stop_to)->name;
+
+            graph::EdgeId id = routes_graph_.AddEdge({ idx_stop_from, idx_stop_to, walking_time });
+            edgeID_to_edge_props_.emplace(id, edge_prop);
+        }
+    }
+}
+
+std::vector<graph::EdgeId> Transport_router::AddBusEdges(const Bus& bus) {
+    return AddBusEdges(bus, MakeBusEdges(bus));
+}
+
+std::vector<graph::EdgeId> Transport_router::AddBusEdges(const Bus& bus, Bus_Edges new_edges) {
+    std::vector<graph::EdgeId>& bus_edges = bus_to_edges_[&bus];
+    std::vector<graph::EdgeId> added_edges;
+
+    for (auto& [stops_indexes, edge_prop] : new_edges) {
+        graph::EdgeId id = routes_graph_.AddEdge({ stops_indexes.first, stops_indexes.second, edge_prop.travel_time });
+
+        edgeID_to_edge_props_.emplace(id, edge_prop);
+        bus_edges.push_back(id);
+        added_edges.push_back(id);
+    }
+
+    return added_edges;
+}
+
+void Transport_router::UpdateBusEdges(const Bus& bus, std::vector<graph::EdgeId>& removed_edges,
+                                      std::vector<graph::EdgeId>& added_edges) {
+    std::vector<graph::EdgeId>& bus_edges = bus_to_edges_[&bus];
+
+    auto new_edges = MakeBusEdges(bus);
+
+    // edges which did not change keep their ids, so routes through them stay valid
+    std::vector<graph::EdgeId> kept_edges;
+
+    for (graph::EdgeId id : bus_edges) {
+        const auto& edge = routes_graph_.GetEdge(id);
+        const Edge_props& props = edgeID_to_edge_props_.at(id);
+
+        auto it = new_edges.find({ edge.from, edge.to });
+
+        if (it != new_edges.end() && it->second.distance == props.distance && it->second.span_count == props.span_count
+            && it->second.stop_from == props.stop_from) {
+            kept_edges.push_back(id);
+            new_edges.erase(it);
+        } else {
+            routes_graph_.RemoveEdge(id);
+            edgeID_to_edge_props_.erase(id);
+            removed_edges.push_back(id);
+        }
+    }
+
+    bus_edges = std::move(kept_edges);
+
+    for (auto& [stops_indexes, edge_prop] : new_edges) {
+        graph::EdgeId id = routes_graph_.AddEdge({ stops_indexes.first, stops_indexes.second, edge_prop.travel_time });
+
+        edgeID_to_edge_props_.emplace(id, edge_prop);
+        bus_edges.push_back(id);
+        added_edges.push_back(id);
+    }
+}
+
+Transport_router::Bus_Edges Transport_router::MakeBusEdges(const Bus& bus) const {
     // dictionary for put and after remove the biggest edges and transfer later to graph.AddEdge
-    std::unordered_map<std::pair<graph::VertexId, graph::VertexId>, Edge_props, tc::StopsDistanceHash> tmp_pair_idx_to_distance;
+    Bus_Edges tmp_pair_idx_to_distance;
+    // it is a temporary storage for subsequent distance/time calculation
+    std::unordered_map<std::pair<graph::VertexId, graph::VertexId>, int, tc::StopsDistanceHash> pair_idx_to_distance;
 
     graph::VertexId idx_stop_from = 0;
 
     graph::VertexId idx_prev_stop_to = 0;
     graph::VertexId idx_current_stop_to = 0;
 
-    for (const Bus& bus : transport_catalogue_.GetAllBuses()) {
+    if (bus.stops.empty()) {
+        return tmp_pair_idx_to_distance;
+    }
+
+    for (auto it_outer = bus.stops.begin(); it_outer + 1 != bus.stops.end(); ++it_outer) {
+        int span_count = 0;
+
+        const Stop* stop_from = transport_catalogue_.GetStopByName(*it_outer);
+        idx_stop_from = transport_catalogue_.GetStopIndex(stop_from);
 
-        for (auto it_outer = bus.stops.begin(); it_outer + 1 != bus.stops.end(); ++it_outer) {
-            int span_count = 0;
+        constexpr int zero_stop_distance = 0;
+        pair_idx_to_distance[{ idx_stop_from, idx_stop_from }] = zero_stop_distance;
 
-            const Stop* stop_from = transport_catalogue_.GetStopByName(*it_outer);
-            idx_stop_from = transport_catalogue_.GetStopIndex(stop_from);
+        for (auto it_inner = it_outer + 1; it_inner != bus.stops.end(); ++it_inner) {
+            ++span_count;
 
-            constexpr int zero_stop_distance = 0;
-            // it is a temporary storage for subsequent distance/time calculation
-            pair_idx_to_distance_[{ idx_stop_from, idx_stop_from }] = zero_stop_distance;
+            const Stop* prev_stop = transport_catalogue_.GetStopByName(*std::prev(it_inner));
+            const Stop* current_stop = transport_catalogue_.GetStopByName(*it_inner);
 
-            for (auto it_inner = it_outer + 1; it_inner != bus.stops.end(); ++it_inner) {
-                ++span_count;
+            idx_prev_stop_to = transport_catalogue_.GetStopIndex(prev_stop);
+            idx_current_stop_to = transport_catalogue_.GetStopIndex(current_stop);
+
+            auto distance_prev_current = transport_catalogue_.GetDistanceByStopsPair(prev_stop, current_stop);
+            if (distance_prev_current == std::nullopt) {
+                throw std::logic_error("Can't find stops distance"s);
+            }
 
-                const Stop* prev_stop = transport_catalogue_.GetStopByName(*std::prev(it_inner));
-                const Stop* current_stop = transport_catalogue_.GetStopByName(*it_inner);
+            int distance_from_to_current = pair_idx_to_distance.at({ idx_stop_from, idx_prev_stop_to })
+                                           + distance_prev_current.value();
+            pair_idx_to_distance[{ idx_stop_from, idx_current_stop_to }] = distance_from_to_current;
 
-                idx_prev_stop_to = transport_catalogue_.GetStopIndex(prev_stop);
-                idx_current_stop_to = transport_catalogue_.GetStopIndex(current_stop);
+            // to out index
+            Edge_props edge_prop;
 
-                auto distance_prev_current = transport_catalogue_.GetDistanceByStopsPair(prev_stop, current_stop);
-                if (distance_prev_current == std::nullopt) {
-                    throw std::logic_error("Can't find stops distance"s);
+            edge_prop.bus = &bus;
+            edge_prop.span_count = span_count;
+            edge_prop.distance = distance_from_to_current;
+            edge_prop.travel_time = 0.0; // calculate later
+            edge_prop.stop_from = *it_outer;
+
+            auto it_find = tmp_pair_idx_to_distance.find({ idx_stop_from, idx_current_stop_to });
+
+            if (it_find == tmp_pair_idx_to_distance.end()) {
+                tmp_pair_idx_to_distance[{ idx_stop_from, idx_current_stop_to }] = edge_prop;
+            } else if (it_find->second.distance > distance_from_to_current) {
+                tmp_pair_idx_to_distance[{ idx_stop_from, idx_current_stop_to }] = edge_prop;
+            }
+
+            if (!bus.is_roundtrip) {
+                auto distance_current_prev = transport_catalogue_.GetDistanceByStopsPair(current_stop, prev_stop);
+                if (distance_current_prev == std::nullopt) {
+                    throw std::logic_error("can't find stops distance"s);
                 }
 
-                int distance_from_to_current = pair_idx_to_distance_.at({ idx_stop_from, idx_prev_stop_to })
-                                               + distance_prev_current.value();
-                pair_idx_to_distance_[{ idx_stop_from, idx_current_stop_to }] = distance_from_to_current;
+                int distance_current_to_from = pair_idx_to_distance.at({ idx_prev_stop_to, idx_stop_from })
+                                               + distance_current_prev.value();
+                pair_idx_to_distance[{ idx_current_stop_to, idx_stop_from }] = distance_current_to_from;
 
-                // to out index
-                Edge_props edge_prop;
+                // change some fields in edge_prop struct
+                Edge_props edge_prop_rev(edge_prop);
 
-                edge_prop.bus = &bus;
-                edge_prop.span_count = span_count;
-                edge_prop.distance = distance_from_to_current;
-                edge_prop.travel_time = 0.0; // calculate later
-                edge_prop.stop_from = *it_outer;
+                edge_prop_rev.distance = distance_current_to_from;
+                edge_prop_rev.stop_from = *it_inner;
 
-                auto it_find = tmp_pair_idx_to_distance.find({ idx_stop_from, idx_current_stop_to });
+                // to out index
+                auto it_find_rev = tmp_pair_idx_to_distance.find({ idx_current_stop_to, idx_stop_from });
 
-                if (it_find == tmp_pair_idx_to_distance.end()) {
-                    tmp_pair_idx_to_distance[{ idx_stop_from, idx_current_stop_to }] = edge_prop;
-                } else if (it_find->second.distance > distance_from_to_current) {
-                    tmp_pair_idx_to_distance[{ idx_stop_from, idx_current_stop_to }] = edge_prop;
+                if (it_find_rev == tmp_pair_idx_to_distance.end()) {
+                    tmp_pair_idx_to_distance[{ idx_current_stop_to, idx_stop_from }] = edge_prop_rev;
+                } else if (it_find_rev->second.distance > distance_current_to_from) {
+                    tmp_pair_idx_to_distance[{ idx_current_stop_to, idx_stop_from }] = edge_prop_rev;
                 }
+            }
+        }
+    }
 
-                if (!bus.is_roundtrip) {
-                    auto distance_current_prev = transport_catalogue_.GetDistanceByStopsPair(current_stop, prev_stop);
-                    if (distance_current_prev == std::nullopt) {
-                        throw std::logic_error("can't find stops distance"s);
-                    }
+    for (auto& [stops_indexes, props] : tmp_pair_idx_to_distance) {
+        props.travel_time = double(props.distance) / routing_settings_.bus_velocity + double(routing_settings_.bus_wait_time);
+    }
 
-                    int distance_current_to_from = pair_idx_to_distance_.at({ idx_prev_stop_to, idx_stop_from })
-                                                   + distance_current_prev.value();
-                    pair_idx_to_distance_[{ idx_current_stop_to, idx_stop_from }] = distance_current_to_from;
+    return tmp_pair_idx_to_distance;
+}
 
-                    // change some fields in edge_prop struct
-                    Edge_props edge_prop_rev(edge_prop);
+std::vector<graph::EdgeId> Transport_router::RemoveBusEdges(const Bus& bus) {
+    auto it = bus_to_edges_.find(&bus);
 
-                    edge_prop_rev.distance = distance_current_to_from;
-                    edge_prop_rev.stop_from = *it_inner;
+    if (it == bus_to_edges_.end()) {
+        return {};
+    }
 
-                    // to out index
-                    auto it_find_rev = tmp_pair_idx_to_distance.find({ idx_current_stop_to, idx_stop_from });
+    std::vector<graph::EdgeId> bus_edges = std::move(it->second);
+    bus_to_edges_.erase(it);
 
-                    if (it_find_rev == tmp_pair_idx_to_distance.end()) {
-                        tmp_pair_idx_to_distance[{ idx_current_stop_to, idx_stop_from }] = edge_prop_rev;
-                    } else if (it_find_rev->second.distance > distance_current_to_from) {
-                        tmp_pair_idx_to_distance[{ idx_current_stop_to, idx_stop_from }] = edge_prop_rev;
-                    }
-                }
+    for (graph::EdgeId id : bus_edges) {
+        routes_graph_.RemoveEdge(id);
+        edgeID_to_edge_props_.erase(id);
+    }
+
+    return bus_edges;
+}
+
+bool Transport_router::IsValidUpdate(const Transport_Update& update) const {
+    std::unordered_set<std::pair<const Stop*, const Stop*>, tc::StopsDistanceHash> new_distances;
+
+    for (const auto& road_distance : update.road_distances) {
+        const Stop* stop_from = transport_catalogue_.GetStopByName(road_distance.from);
+        const Stop* stop_to = transport_catalogue_.GetStopByName(road_distance.to);
+
+        if (stop_from == nullptr || stop_to == nullptr || road_distance.distance < 0) {
+            return false;
+        }
+
+        new_distances.insert({ stop_from, stop_to });
+    }
+
+    std::unordered_set<std::string_view> added_bus_names;
+
+    for (const Bus& bus : update.add_buses) {
+        // a bus without a segment has no edges, the same name twice would leave one of the buses in the base
+        if (bus.stops.size() < 2 || !added_bus_names.insert(bus.name).second) {
+            return false;
+        }
+
+        for (auto it = bus.stops.begin(); it != bus.stops.end(); ++it) {
+            const Stop* stop = transport_catalogue_.GetStopByName(*it);
+
+            if (stop == nullptr) {
+                return false;
+            }
+
+            if (it == bus.stops.begin()) {
+                continue;
+            }
+
+            const Stop* prev_stop = transport_catalogue_.GetStopByName(*std::prev(it));
+
+            const bool has_distance = transport_catalogue_.GetDistanceByStopsPair(prev_stop, stop)
+                                      || new_distances.count({ prev_stop, stop }) > 0
+                                      || new_distances.count({ stop, prev_stop }) > 0;
+            if (!has_distance) {
+                return false;
             }
         }
+    }
 
-        for (const auto& [stops_indexes, props] : tmp_pair_idx_to_distance) {
+    return true;
+}
 
-            double travel_time = double(props.distance) / routing_settings_.bus_velocity + double(routing_settings_.bus_wait_time);
+std::optional<Update_Stat> Transport_router::ApplyUpdate(graph::RouterBase<double>& router,
+                                                         const Transport_Update& update) {
+    // nothing below fails for a valid update, so the base is either changed as a whole or not at all
+    if (!IsValidUpdate(update)) {
+        return std::nullopt;
+    }
 
-            graph::EdgeId id = routes_graph_.AddEdge({ stops_indexes.first, stops_indexes.second, travel_time });
+    Update_Stat update_stat;
 
-            Edge_props edge_prop(props);
-            edge_prop.travel_time = travel_time;
+    // replaced buses are removed first
+    std::unordered_set<std::string_view> removed_bus_names(update.remove_buses.begin(), update.remove_buses.end());
+    for (const Bus& bus : update.add_buses) {
+        removed_bus_names.insert(bus.name);
+    }
 
-            edgeID_to_edge_props_.emplace(id, edge_prop);
+    // the rest buses are rebuilt if they go between stops with changed distance in any direction
+    std::unordered_set<std::pair<std::string_view, std::string_view>, tc::StopsDistanceHash> changed_segments;
+    for (const auto& road_distance : update.road_distances) {
+        changed_segments.insert({ road_distance.from, road_distance.to });
+        changed_segments.insert({ road_distance.to, road_distance.from });
+    }
+
+    std::vector<const Bus*> rebuilt_buses;
+    std::vector<graph::EdgeId> removed_edges;
+    std::vector<graph::EdgeId> added_edges;
+
+    for (const Bus& bus : transport_catalogue_.GetAllBuses()) {
+        if (removed_bus_names.count(bus.name) > 0) {
+            std::vector<graph::EdgeId> bus_edges = RemoveBusEdges(bus);
+            removed_edges.insert(removed_edges.end(), bus_edges.begin(), bus_edges.end());
+            continue;
         }
+
+        for (size_t i = 1; i < bus.stops.size(); ++i) {
+            if (changed_segments.count({ bus.stops[i - 1], bus.stops[i] }) > 0) {
+                rebuilt_buses.push_back(&bus);
+                break;
+            }
+        }
+    }
+
+    for (std::string_view bus_name : removed_bus_names) {
+        if (transport_catalogue_.RemoveRouteFromBase(bus_name)) {
+            ++update_stat.removed_buses;
+        }
+    }
+
+    for (const auto& road_distance : update.road_distances) {
+        transport_catalogue_.SetStopsDistance(transport_catalogue_.GetStopByName(road_distance.from),
+                                              transport_catalogue_.GetStopByName(road_distance.to),
+                                              road_distance.distance);
+        ++update_stat.changed_distances;
+    }
+
+    for (const Bus* bus : rebuilt_buses) {
+        UpdateBusEdges(*bus, removed_edges, added_edges);
     }
+
+    for (const Bus& bus : update.add_buses) {
+        transport_catalogue_.AddRouteToBase(bus);
+
+        std::vector<graph::EdgeId> bus_edges = AddBusEdges(*transport_catalogue_.GetRouteByBusName(bus.name));
+        added_edges.insert(added_edges.end(), bus_edges.begin(), bus_edges.end());
+        ++update_stat.added_buses;
+    }
+
+    update_stat.rebuilt_buses = static_cast<int>(rebuilt_buses.size());
+    update_stat.removed_edges = removed_edges.size();
+    update_stat.added_edges = added_edges.size();
+    update_stat.repaired_sources = router.Repair(removed_edges, added_edges);
+
+    // derived routers are rebuilt for the changed graph on their next use
+    {
+        std::lock_guard guard(engines_mutex_);
+        overlay_router_.reset();
+        timetable_router_.reset();
+        is_timetable_router_built_ = false;
+    }
+    {
+        std::lock_guard guard(overlay_metrics_mutex_);
+        overlay_metrics_.Clear();
+    }
+
+    // labels can't be repaired, they are built anew and replace the stale file
+    if (hub_labels_) {
+        CreateHubLabels();
+    }
+
+    return update_stat;
+}
+
+std::unique_ptr<graph::RouterBase<double>> Transport_router::CreateRouter() const {
+    constexpr size_t bytes_in_mb = 1024 * 1024;
+
+    switch (routing_settings_.router_mode) {
+    case RouterMode::LAZY:
+        return std::make_unique<graph::LazyRouter<double>>(routes_graph_,
+                                                           routing_settings_.router_cache_size_mb * bytes_in_mb);
+    case RouterMode::MAPPED:
+        return std::make_unique<graph::MappedRouter<double>>(routes_graph_, routing_settings_.router_file);
+    case RouterMode::ALL_PAIRS:
+    default:
+        return std::make_unique<graph::Router<double>>(routes_graph_);
+    }
+}
+
+const geo::SpatialGrid& Transport_router::GetStopsGrid() const {
+    return *stops_grid_;
+}
+
+std::unique_ptr<graph::OverlayRouter> Transport_router::MakeOverlayRouter() const {
+    std::vector<geo::Coordinates> stops_coordinates;
+    stops_coordinates.reserve(transport_catalogue_.GetAllStopsCount());
+
+    // vertexes are indexed by stops
+    for (size_t idx = 0; idx < transport_catalogue_.GetAllStopsCount(); ++idx) {
+        const Stop* stop = transport_catalogue_.GetStopByIndex(idx);
+        stops_coordinates.push_back({ stop->latitude, stop->longitude });
+    }
+
+    return std::make_unique<graph::OverlayRouter>(routes_graph_, stops_coordinates);
+}
+
+const graph::OverlayRouter& Transport_router::GetOverlayRouter() const {
+    std::lock_guard guard(engines_mutex_);
+
+    if (!overlay_router_) {
+        overlay_router_ = MakeOverlayRouter();
+    }
+
+    return *overlay_router_;
+}
+
+std::shared_ptr<const graph::OverlayRouter::Metric>
+Transport_router::GetOverlayMetric(const Routing_settings& routing_settings) const {
+    const std::pair<int, double> metric_key{ routing_settings.bus_wait_time, routing_settings.bus_velocity };
+
+    {
+        std::lock_guard guard(overlay_metrics_mutex_);
+
+        if (const auto* metric = overlay_metrics_.Get(metric_key)) {
+            return *metric;
+        }
+    }
+
+    auto metric = GetOverlayRouter().Customize(GetEdgesWeights(routing_settings));
+
+    std::lock_guard guard(overlay_metrics_mutex_);
+    return overlay_metrics_.Put(metric_key, std::move(metric));
+}
+
+std::vector<double> Transport_router::GetEdgesWeights(const Routing_settings& routing_settings) const {
+    std::vector<double> weights(routes_graph_.GetEdgeCount());
+
+    for (graph::EdgeId id = 0; id < weights.size(); ++id) {
+        if (routes_graph_.IsEdgeRemoved(id)) {
+            continue;
+        }
+
+        const Edge_props& props = GetEdgeProps(id);
+
+        if (props.bus == nullptr) {
+            weights[id] = props.travel_time;
+        } else {
+            weights[id] = double(props.distance) / routing_settings.bus_velocity + double(routing_settings.bus_wait_time);
+        }
+    }
+
+    return weights;
+}
+
+const RaptorRouter* Transport_router::GetTimetableRouter() const {
+    std::lock_guard guard(engines_mutex_);
+
+    if (!is_timetable_router_built_) {
+        auto timetable_router = std::make_unique<RaptorRouter>(transport_catalogue_, routing_settings_);
+
+        if (timetable_router->HasTimetables()) {
+            timetable_router_ = std::move(timetable_router);
+        }
+        is_timetable_router_built_ = true;
+    }
+
+    return timetable_router_.get();
+}
+
+void Transport_router::CreateHubLabels() {
+    if (!routing_settings_.hub_labels_file.empty()) {
+        std::ifstream input(routing_settings_.hub_labels_file, std::ios::binary);
+
+        if (auto hub_labels = graph::HubLabels::Load(input, routes_graph_)) {
+            hub_labels_ = std::make_unique<graph::HubLabels>(std::move(*hub_labels));
+            return;
+        }
+    }
+
+    hub_labels_ = std::make_unique<graph::HubLabels>(graph::HubLabels::Build(routes_graph_));
+
+    if (!routing_settings_.hub_labels_file.empty()) {
+        std::ofstream output(routing_settings_.hub_labels_file, std::ios::binary);
+        hub_labels_->Save(output);
+    }
+}
+
+const graph::HubLabels* Transport_router::GetHubLabels() const {
+    return hub_labels_.get();
+}
+
+const graph::DirectedWeightedGraph<double>& Transport_router::GetGraph() const {
+    return routes_graph_;
 }
 
 const Edge_props& Transport_router::GetEdgeProps(graph::EdgeId id) const {
@@ -1,16 +1,45 @@
 #pragma once
 
+#include "hub_labels.h"
+#include "lazy_router.h"
+#include "mapped_router.h"
+#include "overlay_router.h"
+#include "raptor_router.h"
 #include "router.h"
+#include "spatial_grid.h"
 #include "transport_catalogue.h"
 
+#include <memory>
+#include <mutex>
+
+enum class RouterMode {
+    ALL_PAIRS, // all routes are precomputed at start
+    LAZY,      // shortest path trees are computed on demand and kept in LRU cache
+    MAPPED     // all routes are precomputed into a memory-mapped file
+};
+
 struct Routing_settings {
     int bus_wait_time{};
     double bus_velocity{};
+
+    RouterMode router_mode = RouterMode::ALL_PAIRS;
+    size_t router_cache_size_mb = 256;
+    std::string router_file; // for mapped router, temporary file if empty
+
+    // to walk between arbitrary points and stops, velocity is converted like bus_velocity
+    double walking_velocity = 5.0 * 1000 / 60;
+    double stop_search_radius = 1000.0;
+    // stops closer than this in meters are connected by walking edges, no transfers if zero
+    double walking_transfer_radius = 0.0;
+
+    // precomputed hub labels are loaded from the file or built and saved there
+    std::string hub_labels_file;
 };
 
 struct Route_Element {
     std::string type;
     std::string stop_name;
+    std::string to_stop_name; // walking destination
     std::string bus_name;
     double time{};
     int span_count{};
@@ -23,19 +52,31 @@ struct Route_Stat {
     double bus_wait_time{};
 };
 
+// Work done by an update
+struct Update_Stat {
+    int changed_distances{};
+    int removed_buses{};
+    int added_buses{};
+    int rebuilt_buses{};
+    size_t removed_edges{};
+    size_t added_edges{};
+    size_t repaired_sources{};
+};
+
 struct Edge_props {
-    const Bus* bus;
+    const Bus* bus; // nullptr for walking between stops
     int span_count{};
     int distance{};
     double travel_time{};
     std::string_view stop_from;
+    std::string_view stop_to; // for walking only
 };
 
 class Transport_router {
 
 public:
     Transport_router(graph::DirectedWeightedGraph<double> &routes_graph,
-                     const tc::TransportCatalogue &transport_catalogue, const Routing_settings &routing_settings)
+                     tc::TransportCatalogue &transport_catalogue, const Routing_settings &routing_settings)
         : routes_graph_(routes_graph)
         , transport_catalogue_(transport_catalogue)
         , routing_settings_(routing_settings) {
@@ -43,14 +84,71 @@ public:
 
     void CreateGraph();
 
+    // Applies the changes to the catalogue of the router and rebuilds edges of changed buses only.
+    // The router is repaired for affected sources, derived routers are rebuilt.
+    // Returns std::nullopt and changes nothing if the update refers to unknown stops or misses distances
+    std::optional<Update_Stat> ApplyUpdate(graph::RouterBase<double>& router, const Transport_Update& update);
+
+    // Creates routing engine selected by routing settings over the filled graph
+    std::unique_ptr<graph::RouterBase<double>> CreateRouter() const;
+
+    // Metric-independent preprocessing for routing with arbitrary settings, it is built on first use
+    const graph::OverlayRouter& GetOverlayRouter() const;
+
+    // Overlay router metric for the settings, it is customized on first use and cached
+    std::shared_ptr<const graph::OverlayRouter::Metric> GetOverlayMetric(const Routing_settings& routing_settings) const;
+    std::vector<double> GetEdgesWeights(const Routing_settings& routing_settings) const;
+
+    // Timetable router, it is built on first use. nullptr if no bus has departures
+    const RaptorRouter* GetTimetableRouter() const;
+
+    // Distance oracle for route times, it is loaded from hub_labels_file if the file matches the graph
+    void CreateHubLabels();
+    const graph::HubLabels* GetHubLabels() const;
+
+    // Stops by their vertex indexes
+    const geo::SpatialGrid& GetStopsGrid() const;
+
+    const graph::DirectedWeightedGraph<double>& GetGraph() const;
     const Edge_props& GetEdgeProps(graph::EdgeId) const;
     const Routing_settings& GetRouterSettings() const;
 
+private:
+    using Bus_Edges = std::unordered_map<std::pair<graph::VertexId, graph::VertexId>, Edge_props, tc::StopsDistanceHash>;
+
+    // the shortest ride of the bus for every pair of its stops
+    Bus_Edges MakeBusEdges(const Bus& bus) const;
+
+    std::vector<graph::EdgeId> AddBusEdges(const Bus& bus);
+    std::vector<graph::EdgeId> AddBusEdges(const Bus& bus, Bus_Edges new_edges);
+    void AddWalkingEdges();
+    std::vector<graph::EdgeId> RemoveBusEdges(const Bus& bus);
+    void UpdateBusEdges(const Bus& bus, std::vector<graph::EdgeId>& removed_edges,
+                        std::vector<graph::EdgeId>& added_edges);
+    // Everything the update refers to exists and every added bus can be turned into edges
+    bool IsValidUpdate(const Transport_Update& update) const;
+
+    std::unique_ptr<graph::OverlayRouter> MakeOverlayRouter() const;
+
 private:
     graph::DirectedWeightedGraph<double>& routes_graph_; // will be modified
-    const tc::TransportCatalogue& transport_catalogue_;
+    tc::TransportCatalogue& transport_catalogue_; // changed by updates only
     const Routing_settings& routing_settings_;
 
+    std::unique_ptr<geo::SpatialGrid> stops_grid_;
+    std::unique_ptr<graph::HubLabels> hub_labels_;
+
+    // engines of requests with own settings or departure time, only runs with such requests pay for them
+    mutable std::mutex engines_mutex_;
+    mutable std::unique_ptr<graph::OverlayRouter> overlay_router_;
+    mutable std::unique_ptr<RaptorRouter> timetable_router_;
+    mutable bool is_timetable_router_built_ = false;
+
+    static constexpr size_t OVERLAY_METRICS_CACHE_SIZE = 16;
+    mutable std::mutex overlay_metrics_mutex_;
+    mutable LruCache<std::pair<int, double>, std::shared_ptr<const graph::OverlayRouter::Metric>, tc::StopsDistanceHash>
+            overlay_metrics_{ OVERLAY_METRICS_CACHE_SIZE };
+
     std::unordered_map<graph::EdgeId, Edge_props> edgeID_to_edge_props_;
-    std::unordered_map<std::pair<graph::VertexId, graph::VertexId>, int, tc::StopsDistanceHash> pair_idx_to_distance_;
+    std::unordered_map<const Bus*, std::vector<graph::EdgeId>> bus_to_edges_;
 };